@@ -0,0 +1,334 @@
+#include "Arena.hpp"
+#include "Hash.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+// Stateless per-snake randomness (splitmix64), so planning in parallel needs
+// no shared generator and does not depend on scheduling
+uint64_t mixBits(uint64_t value) {
+	value += 0x9E3779B97F4A7C15ull;
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+	return value ^ (value >> 31);
+}
+
+} // namespace
+
+const int32_t Arena::noOwner;
+
+Arena::Arena(const ArenaConfig& config):
+	config(config),
+	cellCount(config.gridWidth * config.gridHeight),
+	owner(static_cast<size_t>(cellCount), noOwner),
+	food(static_cast<size_t>(cellCount), 0),
+	claims(new std::atomic<uint8_t>[cellCount]),
+	rng(config.seed) {
+	for (int cell = 0; cell < cellCount; ++cell) {
+		claims[cell].store(0, std::memory_order_relaxed);
+	}
+
+	snakes.reserve(config.snakeCount);
+	for (int i = 0; i < config.snakeCount; ++i) {
+		// One spare slot: the new head goes in before the tail comes off
+		snakes.emplace_back(config.maxLength + 1);
+		spawn(i);
+	}
+	topUpFood();
+}
+
+Cell Arena::step(Cell cell, Direction direction) const {
+	return stepCell(cell, direction, config.gridWidth, config.gridHeight);
+}
+
+bool Arena::findFreeCell(Cell& out, bool allowFood) {
+	// Rejection sampling: the arena is meant to stay sparse, and a crowded
+	// one just skips a spawn until cells free up
+	std::uniform_int_distribution<int> cellDist(0, cellCount - 1);
+	for (int attempt = 0; attempt < 32; ++attempt) {
+		Cell cell = static_cast<Cell>(cellDist(rng));
+		if (owner[cell] == noOwner && (allowFood || !food[cell])) {
+			out = cell;
+			return true;
+		}
+	}
+	return false;
+}
+
+void Arena::spawn(int index) {
+	ArenaSnake& snake = snakes[index];
+	Cell cell;
+	if (!findFreeCell(cell, false)) {
+		return; // stays dead, tried again next tick
+	}
+	snake.body.clear();
+	snake.body.pushBack(cell);
+	owner[cell] = index;
+	snake.direction = directions[rng() % 4];
+	snake.length = std::min(3, config.maxLength);
+	snake.score = 0;
+	snake.alive = true;
+}
+
+void Arena::topUpFood() {
+	while (foodTotal < config.foodCount) {
+		Cell cell;
+		if (!findFreeCell(cell, false)) {
+			return;
+		}
+		food[cell] = 1;
+		++foodTotal;
+	}
+}
+
+void Arena::tick(ThreadPool& pool) {
+	int count = static_cast<int>(snakes.size());
+	pool.parallelFor(count, [this](int index) { plan(index); }, grain);
+	pool.parallelFor(count, [this](int index) { resolve(index); }, grain);
+	pool.parallelFor(count, [this](int index) { apply(index); }, grain);
+
+	// Serial bookkeeping in snake order, which keeps the spawn RNG sequence
+	// independent of the pool
+	for (int i = 0; i < count; ++i) {
+		ArenaSnake& snake = snakes[i];
+		if (snake.alive) {
+			++stats.moves;
+			if (snake.fate == Fate::Eat) {
+				++stats.foodEaten;
+				--foodTotal;
+			}
+			continue;
+		}
+		if (snake.fate == Fate::HeadOn || snake.fate == Fate::Body) {
+			// Died this tick: the body turns into food, up to twice the
+			// usual amount on the board so wrecks cannot fill the arena
+			++(snake.fate == Fate::HeadOn ? stats.headOnDeaths : stats.bodyDeaths);
+			snake.body.forEach([this](Cell cell) {
+				if (foodTotal < config.foodCount * 2) {
+					food[cell] = 1;
+					++foodTotal;
+				}
+			});
+			snake.body.clear();
+			snake.fate = Fate::Move;
+		}
+		spawn(i);
+	}
+	topUpFood();
+
+	++tickCount;
+	++stats.ticks;
+}
+
+ArenaStats Arena::run(int ticks, ThreadPool& pool) {
+	auto start = std::chrono::steady_clock::now();
+	for (int t = 0; t < ticks; ++t) {
+		tick(pool);
+	}
+	stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return stats;
+}
+
+void Arena::plan(int index) {
+	ArenaSnake& snake = snakes[index];
+	if (!snake.alive) {
+		return;
+	}
+
+	const int width = config.gridWidth, height = config.gridHeight;
+	Cell head = snake.body.front();
+	int headX = static_cast<int>(head % width);
+	int headY = static_cast<int>(head / width);
+
+	// Nearest food in a small window around the head, read straight from the
+	// food grid
+	const int radius = 4;
+	int foodDx = 0, foodDy = 0, foodDistance = INT_MAX;
+	for (int dy = -radius; dy <= radius; ++dy) {
+		int row = ((headY + dy + height) % height) * width;
+		for (int dx = -radius; dx <= radius; ++dx) {
+			int distance = std::abs(dx) + std::abs(dy);
+			if (distance < foodDistance && food[row + (headX + dx + width) % width]) {
+				foodDistance = distance;
+				foodDx = dx;
+				foodDy = dy;
+			}
+		}
+	}
+
+	// Score the three legal moves: free cells only, closer to food is better,
+	// cells another head could also enter are risky, and a little random
+	// preference for going straight so bots wander
+	uint64_t bits = mixBits(config.seed ^ (static_cast<uint64_t>(index) << 32) ^ tickCount);
+	Direction reverse = opposite(snake.direction);
+	Direction best = snake.direction;
+	int bestScore = INT_MIN;
+	for (Direction direction : directions) {
+		if (direction == reverse) {
+			continue;
+		}
+		Cell next = step(head, direction);
+		if (owner[next] != noOwner) {
+			continue;
+		}
+		int score = static_cast<int>(bits & 7);
+		bits >>= 3;
+		if (direction == snake.direction) {
+			score += 4;
+		}
+		for (Direction around : directions) {
+			Cell neighbour = step(next, around);
+			int32_t other = owner[neighbour];
+			// Bodies do not move during planning, so peeking at another
+			// snake's head is safe
+			if (neighbour != head && other != noOwner && snakes[other].body.front() == neighbour) {
+				score -= 64;
+			}
+		}
+		if (foodDistance != INT_MAX) {
+			int dx = foodDx, dy = foodDy;
+			switch (direction) {
+				case Direction::UP:    --dy; break;
+				case Direction::DOWN:  ++dy; break;
+				case Direction::LEFT:  ++dx; break;
+				case Direction::RIGHT: --dx; break;
+			}
+			score -= (std::abs(dx) + std::abs(dy)) * 16;
+		}
+		if (score > bestScore) {
+			bestScore = score;
+			best = direction;
+		}
+	}
+
+	// With nowhere free to go the snake keeps its direction and dies there
+	snake.nextDirection = best;
+	snake.target = step(head, best);
+	claims[snake.target].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Arena::resolve(int index) {
+	ArenaSnake& snake = snakes[index];
+	if (!snake.alive) {
+		return;
+	}
+	// Only the start-of-tick state is read, so the outcome does not depend on
+	// the order snakes are resolved in
+	if (claims[snake.target].load(std::memory_order_relaxed) > 1) {
+		snake.fate = Fate::HeadOn;
+	}
+	else if (owner[snake.target] != noOwner) {
+		snake.fate = Fate::Body;
+	}
+	else {
+		snake.fate = food[snake.target] ? Fate::Eat : Fate::Move;
+	}
+}
+
+void Arena::apply(int index) {
+	ArenaSnake& snake = snakes[index];
+	if (!snake.alive) {
+		return;
+	}
+	// Any number of threads may reset the same contested cell, all to 0
+	claims[snake.target].store(0, std::memory_order_relaxed);
+
+	if (snake.fate == Fate::HeadOn || snake.fate == Fate::Body) {
+		// Its cells were this snake's alone; the serial pass turns them into food
+		snake.body.forEach([this](Cell cell) { owner[cell] = noOwner; });
+		snake.alive = false;
+		return;
+	}
+
+	// The target was free and claimed by this snake only
+	owner[snake.target] = index;
+	snake.body.pushFront(snake.target);
+	snake.direction = snake.nextDirection;
+	if (snake.fate == Fate::Eat) {
+		food[snake.target] = 0;
+		snake.score += 5;
+		snake.length = std::min(snake.length + 1, config.maxLength);
+	}
+	while (static_cast<int>(snake.body.size()) > snake.length) {
+		owner[snake.body.back()] = noOwner;
+		snake.body.popBack();
+	}
+}
+
+int Arena::aliveCount() const {
+	return static_cast<int>(std::count_if(snakes.begin(), snakes.end(), [](const ArenaSnake& snake) { return snake.alive; }));
+}
+
+int Arena::longestSnake() const {
+	size_t longest = 0;
+	for (const auto& snake : snakes) {
+		longest = std::max(longest, snake.body.size());
+	}
+	return static_cast<int>(longest);
+}
+
+uint64_t Arena::stateHash() const {
+	uint64_t hash = hashSeed;
+	auto mix = [&hash](uint32_t value) { hashWord(hash, value); };
+
+	for (const auto& snake : snakes) {
+		mix(snake.alive ? static_cast<uint32_t>(snake.body.size()) : 0u);
+		snake.body.forEach(mix);
+		mix(static_cast<uint32_t>(snake.score));
+	}
+	for (int cell = 0; cell < cellCount; ++cell) {
+		if (food[cell]) {
+			mix(static_cast<uint32_t>(cell));
+		}
+	}
+	return hash;
+}
+
+void runArenaBenchmark(int snakeCount, int gridSize, int ticks) {
+	ArenaConfig config;
+	config.gridWidth = gridSize;
+	config.gridHeight = gridSize;
+	config.snakeCount = snakeCount;
+	config.foodCount = snakeCount;
+
+	int hardwareThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	std::cout << "Arena: " << snakeCount << " snakes on " << gridSize << "x" << gridSize << ", " << ticks << " ticks" << std::endl;
+	std::cout << std::setw(10) << "threads" << std::setw(12) << "ticks/sec" << std::setw(14) << "moves/sec" << std::setw(10) << "speedup"
+		<< std::setw(10) << "eaten" << std::setw(10) << "head-on" << std::setw(10) << "body" << std::setw(8) << "alive"
+		<< std::setw(9) << "longest" << std::endl;
+
+	double baseline = 0.0;
+	uint64_t baselineHash = 0;
+	bool match = true;
+	for (int threads = 1; ; threads = std::min(threads * 2, hardwareThreads)) {
+		ThreadPool pool(threads);
+		Arena arena(config);
+		ArenaStats result = arena.run(ticks, pool);
+		if (threads == 1) {
+			baseline = result.ticksPerSecond();
+			baselineHash = arena.stateHash();
+		}
+		match = match && arena.stateHash() == baselineHash;
+
+		std::cout << std::setw(10) << threads
+			<< std::setw(12) << std::fixed << std::setprecision(1) << result.ticksPerSecond()
+			<< std::setw(14) << static_cast<long long>(result.movesPerSecond())
+			<< std::setw(10) << std::setprecision(2) << result.ticksPerSecond() / baseline
+			<< std::setw(10) << result.foodEaten
+			<< std::setw(10) << result.headOnDeaths
+			<< std::setw(10) << result.bodyDeaths
+			<< std::setw(8) << arena.aliveCount()
+			<< std::setw(9) << arena.longestSnake() << std::endl;
+
+		if (threads == hardwareThreads) {
+			break;
+		}
+	}
+	std::cout << "Final state " << (match ? "matches" : "DIFFERS") << " across thread counts" << std::endl;
+}
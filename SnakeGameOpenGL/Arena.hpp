@@ -0,0 +1,110 @@
+#pragma once
+#include "Simulation.hpp"
+#include "SnakeBody.hpp"
+#include "ThreadPool.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+struct ArenaConfig {
+	int gridWidth = 512;
+	int gridHeight = 512;
+	int snakeCount = 4000;
+	int foodCount = 4000;   // kept topped up to this many items
+	int maxLength = 64;     // snakes stop growing here, eating still scores
+	uint32_t seed = 1234u;
+};
+
+struct ArenaStats {
+	long long ticks = 0;
+	long long moves = 0;          // snake moves over all ticks
+	long long foodEaten = 0;
+	long long headOnDeaths = 0;   // two or more heads entering the same cell
+	long long bodyDeaths = 0;     // head entering any occupied cell
+	double seconds = 0.0;
+
+	double ticksPerSecond() const { return seconds > 0.0 ? ticks / seconds : 0.0; }
+	double movesPerSecond() const { return seconds > 0.0 ? moves / seconds : 0.0; }
+};
+
+// Many bot snakes and many food items on one wrapped grid. The grid itself
+// is the spatial index: one owner entry per cell (snake id or free) and one
+// food byte per cell, so collision and food lookups are single reads
+// whatever the snake count.
+//
+// A tick runs in phases over the ThreadPool, each a parallelFor over snakes:
+//  1. plan:    every live snake picks its move from the state at the start of
+//              the tick and claims the target cell (an atomic count per cell)
+//  2. resolve: a snake dies if its target was occupied at the start of the
+//              tick (bodies, heads and tails alike, as in Simulation) or
+//              claimed by more than one head
+//  3. apply:   survivors move and eat, the dead leave the grid. Every cell
+//              written belongs to exactly one snake, so there are no races.
+// Dead bodies turning into food, respawns and food top-up run serially
+// afterwards in snake order. Nothing
+// depends on which thread ran what, so results match for any pool size.
+class Arena {
+public:
+	explicit Arena(const ArenaConfig& config);
+
+	void tick(ThreadPool& pool);
+	ArenaStats run(int ticks, ThreadPool& pool);
+
+	const ArenaStats& getStats() const { return stats; }
+	int aliveCount() const;
+	int longestSnake() const;
+	// FNV-1a over every body, food cell and score; equal runs hash equal
+	uint64_t stateHash() const;
+
+private:
+	static const int32_t noOwner = -1;
+	static const int grain = 256; // snakes per stolen range
+
+	enum class Fate : uint8_t { Move, Eat, HeadOn, Body };
+
+	// The trailing cache line of padding keeps neighbouring snakes, written
+	// by different threads, off each other's lines however the vector's
+	// storage is aligned (no aligned operator new before C++17)
+	struct ArenaSnake {
+		explicit ArenaSnake(int capacity): body(capacity) {}
+
+		SnakeBody body; // head first
+		Direction direction = Direction::RIGHT;
+		int length = 0;  // target length, the body grows towards it
+		int score = 0;
+		bool alive = false;
+
+		// Written in plan/resolve, read in apply
+		Cell target = 0;
+		Direction nextDirection = Direction::RIGHT;
+		Fate fate = Fate::Move;
+
+		char padding[64];
+	};
+
+	ArenaConfig config;
+	int cellCount;
+	std::vector<ArenaSnake> snakes;
+	std::vector<int32_t> owner;
+	std::vector<uint8_t> food;
+	std::unique_ptr<std::atomic<uint8_t>[]> claims; // heads entering each cell this tick
+	int foodTotal = 0;
+	uint32_t tickCount = 0;
+	std::mt19937 rng; // spawns only, serial
+	ArenaStats stats;
+
+	Cell step(Cell cell, Direction direction) const;
+	bool findFreeCell(Cell& out, bool allowFood);
+	void spawn(int index);
+	void topUpFood();
+
+	void plan(int index);
+	void resolve(int index);
+	void apply(int index);
+};
+
+// ticks/sec of one arena run on 1, 2, 4, ... hardware threads, with a check
+// that every thread count ends in the same state
+void runArenaBenchmark(int snakeCount, int gridSize, int ticks);
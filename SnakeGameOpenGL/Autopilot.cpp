@@ -0,0 +1,186 @@
+#include "Autopilot.hpp"
+#include <algorithm>
+
+Autopilot::Autopilot(int gridWidth, int gridHeight):
+	gridWidth(gridWidth), gridHeight(gridHeight) {
+	size_t cells = static_cast<size_t>(gridWidth) * gridHeight;
+	size_t words = (cells + 63) / 64;
+	walls.resize(words);
+	futureWalls.resize(words);
+	visited.resize(words);
+	queue.resize(cells);
+	parent.resize(cells);
+	path.reserve(cells);
+	futureBody.reserve(cells + 1);
+}
+
+void Autopilot::clear(Bitboard& bits) {
+	std::fill(bits.begin(), bits.end(), 0);
+}
+
+Cell Autopilot::step(Cell cell, Direction direction) const {
+	return stepCell(cell, direction, gridWidth, gridHeight);
+}
+
+int Autopilot::search(const Bitboard& blocked, Cell start, Cell goal) {
+	if (start == goal) {
+		return 0;
+	}
+	clear(visited);
+	set(visited, start);
+	size_t read = 0, write = 0;
+	queue[write++] = start;
+
+	while (read < write) {
+		Cell cell = queue[read++];
+		for (Direction direction : directions) {
+			Cell next = step(cell, direction);
+			if (test(visited, next)) {
+				continue;
+			}
+			parent[next] = cell;
+			if (next == goal) {
+				int length = 0;
+				for (Cell at = goal; at != start; at = parent[at]) {
+					++length;
+				}
+				return length;
+			}
+			if (test(blocked, next)) {
+				continue;
+			}
+			set(visited, next);
+			queue[write++] = next;
+		}
+	}
+	return -1;
+}
+
+int Autopilot::floodCount(const Bitboard& blocked, Cell start) {
+	clear(visited);
+	set(visited, start);
+	size_t read = 0, write = 0;
+	queue[write++] = start;
+
+	while (read < write) {
+		Cell cell = queue[read++];
+		for (Direction direction : directions) {
+			Cell next = step(cell, direction);
+			if (!test(visited, next) && !test(blocked, next)) {
+				set(visited, next);
+				queue[write++] = next;
+			}
+		}
+	}
+	return static_cast<int>(write);
+}
+
+void Autopilot::buildFuture(const SnakeBody& snake, const Cell* moves, size_t moveCount, size_t length) {
+	futureBody.clear();
+	for (size_t i = 0; i < moveCount && futureBody.size() < length; ++i) {
+		futureBody.push_back(moves[i]);
+	}
+	for (size_t i = 0; i < snake.size() && futureBody.size() < length; ++i) {
+		futureBody.push_back(snake[i]);
+	}
+
+	clear(futureWalls);
+	for (Cell cell : futureBody) {
+		set(futureWalls, cell);
+	}
+}
+
+int Autopilot::tailDistance() {
+	// A length-1 snake is its own tail and can always go on
+	if (futureBody.size() < 2) {
+		return 0;
+	}
+	return search(futureWalls, futureBody.front(), futureBody.back());
+}
+
+Command Autopilot::decide(const Simulation& simulation) {
+	if (simulation.getState() != GameState::Playing) {
+		return Command::None;
+	}
+
+	const SnakeBody& snake = simulation.getSnake();
+	Cell head = snake.front();
+	Cell food = simulation.cellIndex(simulation.getFood());
+	Direction reverse = opposite(simulation.getDirection());
+
+	clear(walls);
+	snake.forEach([this](Cell cell) { set(walls, cell); });
+	// Reversing is not a legal turn even for a lone head; block the cell
+	// behind it for the first step
+	Cell behind = step(head, reverse);
+	bool behindWasFree = !test(walls, behind);
+	if (behindWasFree) {
+		set(walls, behind);
+	}
+
+	// 1. Straight for the food when the snake can still reach its tail after
+	// eating it
+	int foodDistance = search(walls, head, food);
+	if (foodDistance > 0) {
+		path.clear();
+		for (Cell at = food; at != head; at = parent[at]) {
+			path.push_back(at);
+		}
+		buildFuture(snake, path.data(), path.size(), snake.size() + 1);
+		if (tailDistance() >= 0) {
+			Cell first = path.back();
+			for (Direction direction : directions) {
+				if (step(head, direction) == first) {
+					return turnCommand(direction);
+				}
+			}
+		}
+	}
+	if (behindWasFree) {
+		// Only the first step of the food path needed it; the safety checks
+		// below look at one move ahead and skip the reverse direction anyway
+		walls[behind >> 6] &= ~(uint64_t(1) << (behind & 63));
+	}
+
+	// 2. Safe move that takes the longest way back to the tail, stalling
+	// until the food is safe to take
+	Direction best = simulation.getDirection();
+	int bestDistance = -1;
+	for (Direction direction : directions) {
+		if (direction == reverse) {
+			continue;
+		}
+		Cell next = step(head, direction);
+		if (test(walls, next)) {
+			continue;
+		}
+		size_t length = next == food ? snake.size() + 1 : snake.size();
+		buildFuture(snake, &next, 1, length);
+		int distance = tailDistance();
+		if (distance > bestDistance) {
+			bestDistance = distance;
+			best = direction;
+		}
+	}
+	if (bestDistance >= 0) {
+		return turnCommand(best);
+	}
+
+	// 3. Trapped: buy time in the largest open area
+	int bestArea = -1;
+	for (Direction direction : directions) {
+		if (direction == reverse) {
+			continue;
+		}
+		Cell next = step(head, direction);
+		if (test(walls, next)) {
+			continue;
+		}
+		int area = floodCount(walls, next);
+		if (area > bestArea) {
+			bestArea = area;
+			best = direction;
+		}
+	}
+	return turnCommand(best);
+}
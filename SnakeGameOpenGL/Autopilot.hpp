@@ -0,0 +1,55 @@
+#pragma once
+#include "Simulation.hpp"
+#include <cstdint>
+#include <vector>
+
+// Bot that plays the regular rules (wrapped edges, one food) for soak tests
+// and demos. Each decision:
+//
+//  1. BFS from the head to the food. The path is taken only if, after
+//     following it and growing, the snake could still reach its own tail.
+//  2. Otherwise the safe move (tail still reachable afterwards) with the
+//     longest way round to the tail, so the snake stalls along itself until
+//     the food becomes safe.
+//  3. With no safe move left, the move into the largest open area.
+//
+// Searches run on bitboard copies of the grid (one bit per cell for walls and
+// for visited cells) with queue and parent buffers allocated once for the
+// board, so deciding never touches the heap.
+class Autopilot {
+public:
+	Autopilot(int gridWidth, int gridHeight);
+
+	// Command for the next tick; feed it to Simulation::applyCommand
+	Command decide(const Simulation& simulation);
+
+private:
+	using Bitboard = std::vector<uint64_t>;
+
+	int gridWidth, gridHeight;
+	Bitboard walls;        // the current body
+	Bitboard futureWalls;  // the body after a candidate move or path
+	Bitboard visited;
+	std::vector<Cell> queue;
+	std::vector<Cell> parent;
+	std::vector<Cell> path;       // food first, first step last
+	std::vector<Cell> futureBody; // head first
+
+	static bool test(const Bitboard& bits, Cell cell) { return (bits[cell >> 6] >> (cell & 63)) & 1; }
+	static void set(Bitboard& bits, Cell cell) { bits[cell >> 6] |= uint64_t(1) << (cell & 63); }
+	static void clear(Bitboard& bits);
+
+	Cell step(Cell cell, Direction direction) const;
+
+	// Length of the shortest path from start to goal through cells not in
+	// `blocked` (goal itself may be blocked), or -1. Fills `parent`.
+	int search(const Bitboard& blocked, Cell start, Cell goal);
+	// Cells reachable from start, start included
+	int floodCount(const Bitboard& blocked, Cell start);
+
+	// Puts the body that results from moving along `moves` (newest first)
+	// with the given length into futureBody/futureWalls
+	void buildFuture(const SnakeBody& snake, const Cell* moves, size_t moveCount, size_t length);
+	// Steps from the future head to the future tail, or -1
+	int tailDistance();
+};
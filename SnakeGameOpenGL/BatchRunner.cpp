@@ -0,0 +1,118 @@
+#include "BatchRunner.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+BatchRunner::BatchRunner(int gameCount, int gridWidth, int gridHeight, uint32_t baseSeed):
+	stats(gameCount) {
+	games.reserve(gameCount);
+	for (int i = 0; i < gameCount; ++i) {
+		games.emplace_back(gridWidth, gridHeight, baseSeed + static_cast<uint32_t>(i));
+	}
+}
+
+BatchResult BatchRunner::run(int ticksPerGame, ThreadPool& pool) {
+	auto start = std::chrono::steady_clock::now();
+
+	// One game per range keeps each board on a single core while it runs;
+	// stealing evens out games that take longer (longer snakes, restarts)
+	pool.parallelFor(static_cast<int>(games.size()), [&](int index) {
+		runGame(index, ticksPerGame);
+	});
+
+	BatchResult result;
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	result.ticks = static_cast<long long>(ticksPerGame) * static_cast<long long>(games.size());
+	for (const auto& gameStats : stats) {
+		result.gamesFinished += gameStats.gamesFinished;
+		result.totalScore += gameStats.totalScore;
+	}
+	return result;
+}
+
+void BatchRunner::runGame(int index, int ticks) {
+	Simulation& game = games[index];
+	GameStats& gameStats = stats[index];
+	for (int t = 0; t < ticks; ++t) {
+		if (game.getState() == GameState::GameOver) {
+			gameStats.gamesFinished++;
+			gameStats.totalScore += game.getScore();
+			game.reset();
+		}
+		game.applyCommand(steerTowardFood(game));
+		game.tick();
+	}
+}
+
+Command steerTowardFood(const Simulation& simulation) {
+	int gridWidth = simulation.getGridWidth();
+	int gridHeight = simulation.getGridHeight();
+	Cell headCell = simulation.getSnake().front();
+	glm::ivec2 head = simulation.cellPosition(headCell);
+	glm::ivec2 food = simulation.getFood();
+
+	// Signed distance along the shorter way round each axis
+	int dx = food.x - head.x;
+	int dy = food.y - head.y;
+	if (dx > gridWidth / 2) dx -= gridWidth;
+	if (dx < -gridWidth / 2) dx += gridWidth;
+	if (dy > gridHeight / 2) dy -= gridHeight;
+	if (dy < -gridHeight / 2) dy += gridHeight;
+
+	Direction preferred[4];
+	int count = 0;
+	Direction towardX = dx > 0 ? Direction::RIGHT : Direction::LEFT;
+	Direction towardY = dy > 0 ? Direction::UP : Direction::DOWN;
+	if (std::abs(dx) >= std::abs(dy)) {
+		if (dx != 0) preferred[count++] = towardX;
+		if (dy != 0) preferred[count++] = towardY;
+	}
+	else {
+		if (dy != 0) preferred[count++] = towardY;
+		if (dx != 0) preferred[count++] = towardX;
+	}
+	for (Direction fallback : directions) {
+		if (std::find(preferred, preferred + count, fallback) == preferred + count) {
+			preferred[count++] = fallback;
+		}
+	}
+
+	// Take the first candidate that does not reverse or land on the body
+	Direction reverse = opposite(simulation.getDirection());
+	for (int i = 0; i < count; ++i) {
+		Cell next = stepCell(headCell, preferred[i], gridWidth, gridHeight);
+		if (preferred[i] != reverse && !simulation.isOccupied(next)) {
+			return turnCommand(preferred[i]);
+		}
+	}
+	return Command::None;
+}
+
+void runBatchBenchmark(int gameCount, int ticksPerGame) {
+	int hardwareThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	std::cout << "Batch: " << gameCount << " games x " << ticksPerGame << " ticks (20x20)" << std::endl;
+	std::cout << std::setw(10) << "threads" << std::setw(16) << "ticks/sec" << std::setw(10) << "speedup"
+		<< std::setw(12) << "finished" << std::setw(14) << "total score" << std::endl;
+
+	double baseline = 0.0;
+	for (int threads = 1; ; threads = std::min(threads * 2, hardwareThreads)) {
+		ThreadPool pool(threads);
+		BatchRunner runner(gameCount, 20, 20, 1234u);
+		BatchResult result = runner.run(ticksPerGame, pool);
+		if (threads == 1) {
+			baseline = result.ticksPerSecond();
+		}
+
+		std::cout << std::setw(10) << threads
+			<< std::setw(16) << static_cast<long long>(result.ticksPerSecond())
+			<< std::setw(10) << std::fixed << std::setprecision(2) << result.ticksPerSecond() / baseline
+			<< std::setw(12) << result.gamesFinished
+			<< std::setw(14) << result.totalScore << std::endl;
+
+		if (threads == hardwareThreads) {
+			break;
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Simulation.hpp"
+#include "ThreadPool.hpp"
+#include <vector>
+#include <cstdint>
+
+struct BatchResult {
+	long long ticks = 0;
+	long long gamesFinished = 0;
+	long long totalScore = 0;   // over finished games
+	double seconds = 0.0;
+
+	double ticksPerSecond() const { return seconds > 0.0 ? ticks / seconds : 0.0; }
+};
+
+// N independent boards stepped with the regular Simulation rules, spread over
+// a work-stealing ThreadPool. Game i is seeded with baseSeed + i and only ever
+// touched by one task at a time, so results do not depend on thread count.
+class BatchRunner {
+public:
+	BatchRunner(int gameCount, int gridWidth, int gridHeight, uint32_t baseSeed);
+
+	// Advances every game by ticksPerGame ticks, restarting games that end
+	BatchResult run(int ticksPerGame, ThreadPool& pool);
+
+private:
+	// A full cache line of padding after the counters keeps neighbouring
+	// games' counters on different lines however the vector's storage is
+	// aligned (over-aligned types get no aligned operator new before C++17)
+	struct GameStats {
+		long long gamesFinished = 0;
+		long long totalScore = 0;
+		char padding[64];
+	};
+
+	std::vector<Simulation> games;
+	std::vector<GameStats> stats;
+
+	void runGame(int index, int ticks);
+};
+
+// Cheap deterministic driver for headless runs: head for the food along the
+// shorter wrapped axis, avoiding cells that would end the game immediately.
+Command steerTowardFood(const Simulation& simulation);
+
+// ticks/sec for the same batch on 1, 2, 4, ... hardware threads
+void runBatchBenchmark(int gameCount, int ticksPerGame);
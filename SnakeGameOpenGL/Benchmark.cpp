@@ -0,0 +1,323 @@
+#include "Benchmark.hpp"
+#include "Autopilot.hpp"
+#include "BatchRunner.hpp"
+#include "HeadBatch.hpp"
+#include "Replay.hpp"
+#include "Snapshot.hpp"
+#include "Simulation.hpp"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Run `step` in blocks until roughly `budget` seconds have passed and return
+// the measured steps per second.
+template <typename Step>
+double measureRate(Step&& step, double budget = 0.25) {
+	const int block = 1024;
+	long long steps = 0;
+	auto start = Clock::now();
+	double elapsed = 0.0;
+	do {
+		for (int i = 0; i < block; ++i) {
+			step();
+		}
+		steps += block;
+		elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+	} while (elapsed < budget);
+	return steps / elapsed;
+}
+
+// A snake of fixed length travelling along one wrapped row that is twice as
+// long as the snake, so it never hits itself and every tick does the full
+// collision check, a head push and a tail pop.
+struct CollisionBoard {
+	int width;
+	std::deque<glm::ivec2> snake;
+	std::vector<uint8_t> occupied;
+	int headX;
+
+	explicit CollisionBoard(int length): width(length * 2), occupied(width, 0), headX(length - 1) {
+		for (int i = 0; i < length; ++i) {
+			snake.push_back(glm::ivec2(headX - i, 0));
+			occupied[headX - i] = 1;
+		}
+	}
+
+	glm::ivec2 advance() {
+		headX = (headX + 1) % width;
+		return glm::ivec2(headX, 0);
+	}
+};
+
+} // namespace
+
+void runCollisionBenchmark() {
+	std::cout << "Self-collision: ticks/sec by snake length" << std::endl;
+	std::cout << std::setw(10) << "length" << std::setw(16) << "std::find" << std::setw(16) << "occupancy" << std::endl;
+
+	volatile int hits = 0;
+	for (int length : { 16, 64, 256, 1024, 4096, 16384 }) {
+		CollisionBoard linear(length);
+		double linearRate = measureRate([&]() {
+			glm::ivec2 newHead = linear.advance();
+			if (std::find(linear.snake.begin(), linear.snake.end(), newHead) != linear.snake.end()) {
+				hits = hits + 1;
+			}
+			linear.snake.push_front(newHead);
+			linear.snake.pop_back();
+		});
+
+		CollisionBoard bitmap(length);
+		double bitmapRate = measureRate([&]() {
+			glm::ivec2 newHead = bitmap.advance();
+			if (bitmap.occupied[newHead.x]) {
+				hits = hits + 1;
+			}
+			bitmap.snake.push_front(newHead);
+			bitmap.occupied[newHead.x] = 1;
+			bitmap.occupied[bitmap.snake.back().x] = 0;
+			bitmap.snake.pop_back();
+		});
+
+		std::cout << std::setw(10) << length
+			<< std::setw(16) << static_cast<long long>(linearRate)
+			<< std::setw(16) << static_cast<long long>(bitmapRate) << std::endl;
+	}
+}
+
+namespace {
+
+struct ObjectGame {
+	glm::ivec2 head;
+	Direction direction;
+	glm::ivec2 food;
+	bool ateFood;
+};
+
+void stepObjects(std::vector<ObjectGame>& games, int gridWidth, int gridHeight) {
+	for (auto& game : games) {
+		glm::ivec2 newHead = game.head;
+		switch (game.direction) {
+			case Direction::UP:    newHead.y += 1; break;
+			case Direction::DOWN:  newHead.y -= 1; break;
+			case Direction::LEFT:  newHead.x -= 1; break;
+			case Direction::RIGHT: newHead.x += 1; break;
+		}
+		newHead.x = (newHead.x + gridWidth) % gridWidth;
+		newHead.y = (newHead.y + gridHeight) % gridHeight;
+		game.head = newHead;
+		game.ateFood = newHead == game.food;
+	}
+}
+
+} // namespace
+
+void runHeadStepBenchmark() {
+	const int gameCount = 4096;
+	const int gridWidth = 64, gridHeight = 48;
+
+	std::mt19937 rng(1234u);
+	std::uniform_int_distribution<int> xDist(0, gridWidth - 1);
+	std::uniform_int_distribution<int> yDist(0, gridHeight - 1);
+	std::uniform_int_distribution<int> dirDist(0, 3);
+
+	std::vector<ObjectGame> objects(gameCount);
+	HeadBatch soa(gameCount, gridWidth, gridHeight);
+	HeadBatch soaScalar(gameCount, gridWidth, gridHeight);
+	for (int i = 0; i < gameCount; ++i) {
+		ObjectGame& game = objects[i];
+		game.head = glm::ivec2(xDist(rng), yDist(rng));
+		game.food = glm::ivec2(xDist(rng), yDist(rng));
+		game.direction = static_cast<Direction>(dirDist(rng));
+		game.ateFood = false;
+
+		glm::ivec2 step(0, 0);
+		switch (game.direction) {
+			case Direction::UP:    step.y = 1; break;
+			case Direction::DOWN:  step.y = -1; break;
+			case Direction::LEFT:  step.x = -1; break;
+			case Direction::RIGHT: step.x = 1; break;
+		}
+		for (HeadBatch* batch : { &soa, &soaScalar }) {
+			batch->headX[i] = static_cast<int16_t>(game.head.x);
+			batch->headY[i] = static_cast<int16_t>(game.head.y);
+			batch->dirX[i] = static_cast<int16_t>(step.x);
+			batch->dirY[i] = static_cast<int16_t>(step.y);
+			batch->foodX[i] = static_cast<int16_t>(game.food.x);
+			batch->foodY[i] = static_cast<int16_t>(game.food.y);
+		}
+	}
+
+	// Rates are game-steps/sec: one call advances every game once
+	double objectRate = measureRate([&]() { stepObjects(objects, gridWidth, gridHeight); }) * gameCount;
+	double scalarRate = measureRate([&]() { stepHeadsScalar(soaScalar); }) * gameCount;
+	double simdRate = measureRate([&]() { stepHeads(soa); }) * gameCount;
+
+	std::cout << "Head step: " << gameCount << " games on " << gridWidth << "x" << gridHeight << ", game-steps/sec" << std::endl;
+	std::cout << std::setw(24) << "per-object" << std::setw(16) << static_cast<long long>(objectRate) << std::endl;
+	std::cout << std::setw(24) << "SoA scalar" << std::setw(16) << static_cast<long long>(scalarRate) << std::endl;
+	std::cout << std::setw(24) << stepHeadsKernelName() << std::setw(16) << static_cast<long long>(simdRate) << std::endl;
+
+	// The three paths ran different numbers of steps; realign by stepping a
+	// fresh copy of each a fixed number of times and compare
+	std::vector<ObjectGame> checkObjects = objects;
+	HeadBatch checkSoa = soa;
+	for (int i = 0; i < gameCount; ++i) {
+		checkSoa.headX[i] = static_cast<int16_t>(checkObjects[i].head.x);
+		checkSoa.headY[i] = static_cast<int16_t>(checkObjects[i].head.y);
+	}
+	bool match = true;
+	for (int step = 0; step < 200; ++step) {
+		stepObjects(checkObjects, gridWidth, gridHeight);
+		stepHeads(checkSoa);
+		for (int i = 0; i < gameCount && match; ++i) {
+			match = checkSoa.headX[i] == checkObjects[i].head.x && checkSoa.headY[i] == checkObjects[i].head.y &&
+				(checkSoa.ateFood[i] != 0) == checkObjects[i].ateFood;
+		}
+	}
+	std::cout << "Results " << (match ? "match" : "DIFFER") << " the per-object path" << std::endl;
+}
+
+void runSnapshotBenchmark() {
+	std::cout << "Snapshot: checkpoints/sec and restores/sec of a mid-game state" << std::endl;
+	std::cout << std::setw(10) << "board" << std::setw(8) << "ticks" << std::setw(14) << "checkpoint" << std::setw(14) << "restore"
+		<< std::setw(14) << "replay" << std::endl;
+
+	for (int size : { 20, 64, 256 }) {
+		// Play a game forward with the greedy bot, then fork it many times
+		const uint32_t seed = 99u;
+		const int ticks = size * 50;
+		Simulation original(size, size, seed);
+		for (int i = 0; i < ticks && original.getState() == GameState::Playing; ++i) {
+			original.applyCommand(steerTowardFood(original));
+			original.tick();
+		}
+		uint32_t played = original.getTickCount();
+
+		std::vector<uint8_t> snapshot;
+		double checkpointRate = measureRate([&]() { writeSnapshot(original, 0.0, snapshot); }, 0.1);
+
+		Simulation fork(size, size, 0u);
+		double restoreRate = measureRate([&]() { restoreSnapshot(fork, snapshot.data(), snapshot.size(), nullptr); }, 0.1);
+
+		// Without snapshots the only way back to this state is re-running it
+		auto start = Clock::now();
+		Simulation replayed(size, size, seed);
+		for (uint32_t i = 0; i < played && replayed.getState() == GameState::Playing; ++i) {
+			replayed.applyCommand(steerTowardFood(replayed));
+			replayed.tick();
+		}
+		double replaySeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+		std::cout << std::setw(6) << size << "x" << std::setw(3) << size << std::setw(8) << played
+			<< std::setw(14) << static_cast<long long>(checkpointRate)
+			<< std::setw(14) << static_cast<long long>(restoreRate)
+			<< std::setw(14) << static_cast<long long>(replaySeconds > 0.0 ? 1.0 / replaySeconds : 0.0) << std::endl;
+
+		// A fork must continue exactly like the original
+		Simulation check = original;
+		for (int i = 0; i < 500; ++i) {
+			fork.applyCommand(steerTowardFood(fork));
+			check.applyCommand(steerTowardFood(check));
+			fork.tick();
+			check.tick();
+		}
+		if (fork.stateHash() != check.stateHash()) {
+			std::cout << "Restored state DIFFERS from the original" << std::endl;
+		}
+	}
+}
+
+void runReplayCheck() {
+	const int games = 4;
+	const int maxTicks = 5000;
+	Simulation simulation(20, 20, 0u);
+	ReplayRecorder recorder;
+	int matched = 0;
+	for (int game = 0; game < games; ++game) {
+		uint32_t seed = 1000u + static_cast<uint32_t>(game);
+		simulation.reseed(seed);
+		simulation.applyCommand(Command::Restart);
+		recorder.begin(simulation, seed);
+		for (int i = 0; i < maxTicks && simulation.getState() == GameState::Playing; ++i) {
+			simulation.applyCommand(steerTowardFood(simulation));
+			recorder.beforeTick(simulation);
+			simulation.tick();
+		}
+		recorder.finish(simulation);
+		matched += runReplay(recorder.getReplay()).matched ? 1 : 0;
+	}
+	std::cout << "Replays after restart: " << matched << " of " << games << " match" << std::endl;
+}
+
+void runAutopilotBenchmark() {
+	std::cout << "Autopilot: decisions/sec and score by board size" << std::endl;
+	std::cout << std::setw(10) << "board" << std::setw(14) << "decisions/s" << std::setw(8) << "games"
+		<< std::setw(12) << "avg score" << std::setw(12) << "avg fill" << std::setw(10) << "cut off" << std::endl;
+
+	for (int size : { 10, 20, 40, 80 }) {
+		const int cells = size * size;
+		Simulation simulation(size, size, 7u);
+		Autopilot autopilot(size, size);
+
+		// Whole games on the small boards; the big ones get a time budget and
+		// report the games finished within it
+		const double budget = 2.0;
+		const int maxGames = 20;
+		long long decisions = 0, totalScore = 0;
+		double totalFill = 0.0;
+		int games = 0, cutOff = 0;
+		uint32_t lastFoodTick = 0;
+		int lastScore = 0;
+		double decideSeconds = 0.0;
+
+		auto start = Clock::now();
+		while (games < maxGames && std::chrono::duration<double>(Clock::now() - start).count() < budget) {
+			auto decideStart = Clock::now();
+			Command command = autopilot.decide(simulation);
+			decideSeconds += std::chrono::duration<double>(Clock::now() - decideStart).count();
+			++decisions;
+
+			simulation.applyCommand(command);
+			simulation.tick();
+			if (simulation.getScore() != lastScore) {
+				lastScore = simulation.getScore();
+				lastFoodTick = simulation.getTickCount();
+			}
+
+			// Circling without ever finding a safe way to the food
+			bool stalled = simulation.getTickCount() - lastFoodTick > static_cast<uint32_t>(cells * 4);
+			if (simulation.getState() == GameState::GameOver || stalled) {
+				++games;
+				cutOff += stalled ? 1 : 0;
+				totalScore += simulation.getScore();
+				totalFill += static_cast<double>(simulation.getSnake().size()) / cells;
+				simulation.reset();
+				lastFoodTick = 0;
+				lastScore = 0;
+			}
+		}
+
+		std::cout << std::setw(6) << size << "x" << std::setw(3) << size
+			<< std::setw(14) << static_cast<long long>(decideSeconds > 0.0 ? decisions / decideSeconds : 0.0)
+			<< std::setw(8) << games;
+		if (games > 0) {
+			std::cout << std::setw(12) << std::fixed << std::setprecision(1) << static_cast<double>(totalScore) / games
+				<< std::setw(11) << std::setprecision(1) << totalFill / games * 100.0 << "%";
+		}
+		else {
+			std::cout << std::setw(12) << "-" << std::setw(12) << "-";
+		}
+		std::cout << std::setw(10) << cutOff << std::endl;
+	}
+}
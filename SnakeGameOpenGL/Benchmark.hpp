@@ -0,0 +1,26 @@
+#pragma once
+
+// Headless micro-benchmarks, run with `SnakeGameOpenGL --bench`. None of these
+// need a window or a GL context.
+
+// Ticks/sec against snake length for the old linear std::find self-collision
+// check and the occupancy bitmap used by Simulation.
+void runCollisionBenchmark();
+
+// Head move + wrap + food test for many games in lockstep: per-object
+// glm::ivec2 heads (as in Simulation::tick) against the HeadBatch
+// structure-of-arrays layout with the scalar and SIMD kernels.
+void runHeadStepBenchmark();
+
+// Checkpoint and restore cost of a mid-game Simulation snapshot, against
+// replaying the same game from tick 0.
+void runSnapshotBenchmark();
+
+// Plays several games in one Simulation, restarting it the way Game does
+// (reseed + Command::Restart), and checks that each game's recording
+// replays to the same final state in a fresh Simulation.
+void runReplayCheck();
+
+// Autopilot decisions/sec and average score over complete games, by board
+// size. Games that stop eating for too long are cut off and counted.
+void runAutopilotBenchmark();
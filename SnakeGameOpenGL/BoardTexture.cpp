@@ -0,0 +1,122 @@
+#include "BoardTexture.hpp"
+#include "Profiler.hpp"
+
+BoardTexture::BoardTexture(int gridWidth, int gridHeight, const glm::vec3& emptyColor, const glm::vec3& bodyColor, const glm::vec3& foodColor):
+	gridWidth(gridWidth), gridHeight(gridHeight),
+	cells(static_cast<size_t>(gridWidth) * gridHeight, Empty) {
+	dirty.reserve(8);
+
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, gridWidth, gridHeight, 0, GL_RED, GL_UNSIGNED_BYTE, cells.data());
+	// Read with texelFetch only, but a complete texture needs these
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glGenVertexArrays(1, &vao);
+
+	shader.load("board_vertex.glsl", "board_fragment.glsl");
+	projectionLoc = shader.uniform("projection");
+	rectLoc = shader.uniform("rect");
+
+	// Everything but the view is fixed for the lifetime of the board
+	shader.use();
+	glUniform1i(shader.uniform("board"), 0);
+	glUniform2i(shader.uniform("gridSize"), gridWidth, gridHeight);
+	glUniform3fv(shader.uniform("emptyColor"), 1, &emptyColor[0]);
+	glUniform3fv(shader.uniform("bodyColor"), 1, &bodyColor[0]);
+	glUniform3fv(shader.uniform("foodColor"), 1, &foodColor[0]);
+}
+
+BoardTexture::~BoardTexture() {
+	glDeleteTextures(1, &texture);
+	glDeleteVertexArrays(1, &vao);
+}
+
+void BoardTexture::rebuild(const Simulation& simulation) {
+	const SnakeBody& snake = simulation.getSnake();
+	Cell head = snake.front();
+	for (size_t cell = 0; cell < cells.size(); ++cell) {
+		bool body = simulation.isOccupied(static_cast<Cell>(cell)) && cell != head;
+		cells[cell] = body ? Body : Empty;
+	}
+	foodCell = simulation.cellIndex(simulation.getFood());
+	cells[foodCell] = Food;
+
+	dirty.clear();
+	fullUpload = true;
+}
+
+void BoardTexture::update(const Simulation& simulation) {
+	const SnakeBody& snake = simulation.getSnake();
+
+	// The old head became body and the tail moved off the vacated cell,
+	// unless the snake grew and the tail stayed put
+	if (snake.size() > 1) {
+		set(snake[1], Body);
+	}
+	Cell vacated = simulation.cellIndex(simulation.getPreviousTail());
+	if (vacated != snake.back()) {
+		set(vacated, Empty);
+	}
+
+	// Eaten food sits under the head now
+	Cell food = simulation.cellIndex(simulation.getFood());
+	if (food != foodCell) {
+		set(foodCell, Empty);
+		foodCell = food;
+	}
+	set(foodCell, Food);
+}
+
+void BoardTexture::set(Cell cell, CellState state) {
+	if (cells[cell] != state) {
+		cells[cell] = state;
+		dirty.push_back(cell);
+	}
+}
+
+void BoardTexture::upload() {
+	if (!fullUpload && dirty.empty()) {
+		return;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if (fullUpload) {
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, gridWidth, gridHeight, GL_RED, GL_UNSIGNED_BYTE, cells.data());
+		Profiler::count(ProfileCounter::BufferUploads);
+	}
+	else {
+		for (Cell cell : dirty) {
+			int x = static_cast<int>(cell % gridWidth);
+			int y = static_cast<int>(cell / gridWidth);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, 1, 1, GL_RED, GL_UNSIGNED_BYTE, &cells[cell]);
+		}
+		Profiler::count(ProfileCounter::BufferUploads, dirty.size());
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	dirty.clear();
+	fullUpload = false;
+}
+
+void BoardTexture::draw(const Renderer& renderer, glm::vec2 rectMin, glm::vec2 rectMax) {
+	upload();
+
+	shader.use();
+	glm::mat4 projection = renderer.viewProjection();
+	glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, &projection[0][0]);
+	glUniform4f(rectLoc, rectMin.x, rectMin.y, rectMax.x - rectMin.x, rectMax.y - rectMin.y);
+	Profiler::count(ProfileCounter::UniformUploads, 2);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glBindVertexArray(vao);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	Profiler::count(ProfileCounter::DrawCalls);
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
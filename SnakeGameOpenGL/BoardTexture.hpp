@@ -0,0 +1,51 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "Renderer.hpp"
+#include "ShaderProgram.hpp"
+#include "Simulation.hpp"
+#include <cstdint>
+#include <vector>
+
+// Board kept on the GPU as a gridWidth x gridHeight R8 texture of cell
+// states, drawn in one pass whose fragment shader turns states into colors.
+// A tick changes at most a handful of cells (old head, vacated tail, food), and
+// only those texels are re-uploaded, so the per-frame upload stays a few
+// bytes whatever the board size or snake length.
+//
+// Like ChunkedBoard only the head is left out; Game draws it and the tail
+// interpolated on top.
+class BoardTexture {
+public:
+	BoardTexture(int gridWidth, int gridHeight, const glm::vec3& emptyColor, const glm::vec3& bodyColor, const glm::vec3& foodColor);
+	~BoardTexture();
+	BoardTexture(const BoardTexture&) = delete;
+	BoardTexture& operator=(const BoardTexture&) = delete;
+
+	// Whole board, after a restart or quickload
+	void rebuild(const Simulation& simulation);
+	// After a tick: records only the cells that changed
+	void update(const Simulation& simulation);
+
+	// Fills rectMin..rectMax (in cells, may extend past the board edges,
+	// wrapped copies repeat) with the board, using the renderer's view.
+	// Pending texel changes are uploaded first.
+	void draw(const Renderer& renderer, glm::vec2 rectMin, glm::vec2 rectMax);
+
+private:
+	enum CellState : uint8_t { Empty = 0, Body = 1, Food = 2 };
+
+	int gridWidth, gridHeight;
+	GLuint texture = 0;
+	GLuint vao = 0; // no attributes, the shader builds the quad from gl_VertexID
+	ShaderProgram shader;
+	GLint projectionLoc, rectLoc;
+
+	std::vector<uint8_t> cells; // CPU copy of the texture
+	std::vector<Cell> dirty;    // texels changed since the last upload
+	bool fullUpload = true;
+	Cell foodCell = 0;
+
+	void set(Cell cell, CellState state);
+	void upload();
+};
@@ -0,0 +1,31 @@
+#include "CacheDirectory.hpp"
+#include <cerrno>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+const char* const cacheDirectory = "cache";
+
+bool makeDirectory(const char* path) {
+#ifdef _WIN32
+	return _mkdir(path) == 0 || errno == EEXIST;
+#else
+	return mkdir(path, 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+} // namespace
+
+std::string cacheFilePath(const std::string& fileName) {
+	// One mkdir per run; the static's initialisation is thread-safe
+	static const bool haveDirectory = makeDirectory(cacheDirectory);
+	if (!haveDirectory) {
+		return fileName;
+	}
+	return std::string(cacheDirectory) + "/" + fileName;
+}
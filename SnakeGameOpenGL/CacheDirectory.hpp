@@ -0,0 +1,7 @@
+#pragma once
+#include <string>
+
+// Path of a generated cache file (shader binaries, font atlases) inside the
+// "cache" directory under the working directory, creating the directory the
+// first time. Falls back to the working directory if it can't be created.
+std::string cacheFilePath(const std::string& fileName);
@@ -0,0 +1,85 @@
+#include "ChunkedBoard.hpp"
+#include <algorithm>
+#include <cmath>
+
+ChunkedBoard::ChunkedBoard(Renderer& renderer, int gridWidth, int gridHeight):
+	renderer(renderer), gridWidth(gridWidth), gridHeight(gridHeight),
+	chunksX((gridWidth + chunkSize - 1) / chunkSize),
+	chunksY((gridHeight + chunkSize - 1) / chunkSize),
+	chunks(static_cast<size_t>(chunksX) * chunksY) {
+	scratch.reserve(chunkSize * chunkSize);
+}
+
+void ChunkedBoard::markDirty(Cell cell) {
+	int x = static_cast<int>(cell % gridWidth) / chunkSize;
+	int y = static_cast<int>(cell / gridWidth) / chunkSize;
+	chunks[static_cast<size_t>(y) * chunksX + x].dirty = true;
+}
+
+void ChunkedBoard::markAllDirty() {
+	for (auto& chunk : chunks) {
+		chunk.dirty = true;
+	}
+}
+
+void ChunkedBoard::draw(const Simulation& simulation, glm::vec2 viewMin, glm::vec2 viewMax, const glm::vec3& color) {
+	// Board copies (from wrap-around) that overlap the view
+	int copyX0 = static_cast<int>(std::floor(viewMin.x / gridWidth));
+	int copyX1 = static_cast<int>(std::floor(viewMax.x / gridWidth));
+	int copyY0 = static_cast<int>(std::floor(viewMin.y / gridHeight));
+	int copyY1 = static_cast<int>(std::floor(viewMax.y / gridHeight));
+
+	for (int copyY = copyY0; copyY <= copyY1; ++copyY) {
+		for (int copyX = copyX0; copyX <= copyX1; ++copyX) {
+			glm::vec2 offset(float(copyX * gridWidth), float(copyY * gridHeight));
+
+			// View rectangle in this copy's board coordinates
+			float minX = std::max(viewMin.x - offset.x, 0.0f);
+			float minY = std::max(viewMin.y - offset.y, 0.0f);
+			float maxX = std::min(viewMax.x - offset.x, float(gridWidth));
+			float maxY = std::min(viewMax.y - offset.y, float(gridHeight));
+			if (minX >= maxX || minY >= maxY) {
+				continue;
+			}
+
+			int chunkX0 = static_cast<int>(minX) / chunkSize;
+			int chunkY0 = static_cast<int>(minY) / chunkSize;
+			int chunkX1 = std::min(chunksX - 1, static_cast<int>(std::ceil(maxX)) / chunkSize);
+			int chunkY1 = std::min(chunksY - 1, static_cast<int>(std::ceil(maxY)) / chunkSize);
+
+			for (int chunkY = chunkY0; chunkY <= chunkY1; ++chunkY) {
+				for (int chunkX = chunkX0; chunkX <= chunkX1; ++chunkX) {
+					Chunk& chunk = chunks[static_cast<size_t>(chunkY) * chunksX + chunkX];
+					if (chunk.dirty) {
+						rebuild(chunk, chunkX, chunkY, simulation, color);
+					}
+					renderer.drawLayer(chunk.layer, offset);
+				}
+			}
+		}
+	}
+}
+
+void ChunkedBoard::rebuild(Chunk& chunk, int chunkX, int chunkY, const Simulation& simulation, const glm::vec3& color) {
+	if (chunk.layer < 0) {
+		chunk.layer = renderer.createLayer();
+	}
+
+	const SnakeBody& snake = simulation.getSnake();
+	Cell head = snake.front();
+
+	scratch.clear();
+	int x1 = std::min(gridWidth, (chunkX + 1) * chunkSize);
+	int y1 = std::min(gridHeight, (chunkY + 1) * chunkSize);
+	for (int y = chunkY * chunkSize; y < y1; ++y) {
+		for (int x = chunkX * chunkSize; x < x1; ++x) {
+			Cell cell = static_cast<Cell>(y * gridWidth + x);
+			if (simulation.isOccupied(cell) && cell != head) {
+				scratch.push_back({ glm::vec4(float(x), float(y), 1.0f, 1.0f), color, 0.0f });
+			}
+		}
+	}
+
+	renderer.uploadLayer(chunk.layer, scratch);
+	chunk.dirty = false;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "Renderer.hpp"
+#include "Simulation.hpp"
+#include <vector>
+
+// Snake body split into fixed-size chunks for drawing. Each chunk's quads are
+// cached in a renderer layer and rebuilt only after one of its cells changed,
+// and only chunks overlapping the view are rebuilt or drawn, so frame cost
+// follows what is visible rather than board size or snake length.
+//
+// Only the head is left out: it moves every frame with interpolation and is
+// drawn dynamically by Game. The tail cell stays in the cache so the
+// interpolated tail quad Game draws over it never leaves a gap behind it.
+class ChunkedBoard {
+public:
+	static const int chunkSize = 32;
+
+	ChunkedBoard(Renderer& renderer, int gridWidth, int gridHeight);
+
+	void markDirty(Cell cell);
+	void markAllDirty();
+
+	// viewMin/viewMax are in cells and may extend past the board edges; the
+	// wrapped copies of the board that overlap the view are drawn as well.
+	void draw(const Simulation& simulation, glm::vec2 viewMin, glm::vec2 viewMax, const glm::vec3& color);
+
+private:
+	struct Chunk {
+		LayerHandle layer = -1; // created the first time the chunk is visible
+		bool dirty = true;
+	};
+
+	Renderer& renderer;
+	int gridWidth, gridHeight;
+	int chunksX, chunksY;
+	std::vector<Chunk> chunks;
+	std::vector<QuadInstance> scratch;
+
+	void rebuild(Chunk& chunk, int chunkX, int chunkY, const Simulation& simulation, const glm::vec3& color);
+};
@@ -0,0 +1,196 @@
+#include "FontAtlas.hpp"
+#include "CacheDirectory.hpp"
+#include "Hash.hpp"
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+// Cache file: "SNKF" | u32 version | u64 key | i32 width | i32 height |
+// 128 x GlyphMetrics | width * height pixels
+struct AtlasHeader {
+	char magic[4];
+	uint32_t version;
+	uint64_t key;
+	int32_t width, height;
+};
+
+const uint32_t atlasVersion = 1;
+
+struct RasterizedGlyph {
+	GlyphMetrics metrics{};
+	std::vector<uint8_t> bitmap;
+};
+
+// Rasterizes glyphs [first, last) with a private FreeType instance; faces
+// and libraries must not be shared between threads
+bool rasterizeRange(const uint8_t* fontData, size_t fontSize, int pixelSize, int first, int last, RasterizedGlyph* out) {
+	FT_Library ft;
+	if (FT_Init_FreeType(&ft)) {
+		std::cerr << "ERROR: Could not init FreeType Library" << std::endl;
+		return false;
+	}
+	FT_Face face;
+	if (FT_New_Memory_Face(ft, fontData, static_cast<FT_Long>(fontSize), 0, &face)) {
+		std::cerr << "ERROR: Failed to load font" << std::endl;
+		FT_Done_FreeType(ft);
+		return false;
+	}
+	FT_Set_Pixel_Sizes(face, 0, pixelSize);
+
+	for (int c = first; c < last; ++c) {
+		if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
+			std::cerr << "ERROR::FREETYPE: Failed to load Glyph" << std::endl;
+			continue;
+		}
+		FT_Bitmap& bitmap = face->glyph->bitmap;
+		RasterizedGlyph& glyph = out[c];
+		glyph.metrics.width = static_cast<int32_t>(bitmap.width);
+		glyph.metrics.height = static_cast<int32_t>(bitmap.rows);
+		glyph.metrics.bearingX = face->glyph->bitmap_left;
+		glyph.metrics.bearingY = face->glyph->bitmap_top;
+		glyph.metrics.advance = static_cast<uint32_t>(face->glyph->advance.x);
+
+		glyph.bitmap.resize(static_cast<size_t>(glyph.metrics.width) * glyph.metrics.height);
+		for (int row = 0; row < glyph.metrics.height; ++row) {
+			std::memcpy(&glyph.bitmap[static_cast<size_t>(row) * glyph.metrics.width],
+				bitmap.buffer + row * bitmap.pitch, glyph.metrics.width);
+		}
+	}
+
+	FT_Done_Face(face);
+	FT_Done_FreeType(ft);
+	return true;
+}
+
+std::unique_ptr<FontAtlas> bakeAtlas(const MappedFile& font, int pixelSize) {
+	std::array<RasterizedGlyph, 128> glyphs;
+
+	// Split the character set over a few threads; each pays for its own
+	// FreeType setup, so there is little point in going wider
+	int threads = static_cast<int>(std::min(4u, std::max(1u, std::thread::hardware_concurrency())));
+	int perThread = (128 + threads - 1) / threads;
+	std::vector<std::future<bool>> parts;
+	for (int first = 0; first < 128; first += perThread) {
+		int last = std::min(128, first + perThread);
+		parts.push_back(std::async(std::launch::async, rasterizeRange, font.data(), font.size(), pixelSize, first, last, glyphs.data()));
+	}
+	bool ok = true;
+	for (auto& part : parts) {
+		ok = part.get() && ok;
+	}
+	if (!ok) {
+		return nullptr;
+	}
+
+	// Shelf-pack everything into one atlas
+	auto atlas = std::unique_ptr<FontAtlas>(new FontAtlas());
+	const int atlasWidth = 512;
+	const int padding = 1;
+	int penX = padding, penY = padding, rowHeight = 0;
+	for (int c = 0; c < 128; ++c) {
+		GlyphMetrics& metrics = glyphs[c].metrics;
+		if (penX + metrics.width + padding > atlasWidth) {
+			penX = padding;
+			penY += rowHeight + padding;
+			rowHeight = 0;
+		}
+		metrics.x = penX;
+		metrics.y = penY;
+		penX += metrics.width + padding;
+		rowHeight = std::max(rowHeight, static_cast<int>(metrics.height));
+		atlas->glyphs[c] = metrics;
+	}
+
+	atlas->width = atlasWidth;
+	atlas->height = penY + rowHeight + padding;
+	atlas->bakedPixels.assign(static_cast<size_t>(atlas->width) * atlas->height, 0);
+	for (int c = 0; c < 128; ++c) {
+		const GlyphMetrics& metrics = glyphs[c].metrics;
+		for (int row = 0; row < metrics.height; ++row) {
+			std::memcpy(&atlas->bakedPixels[static_cast<size_t>(metrics.y + row) * atlas->width + metrics.x],
+				&glyphs[c].bitmap[static_cast<size_t>(row) * metrics.width], metrics.width);
+		}
+	}
+	atlas->pixels = atlas->bakedPixels.data();
+	return atlas;
+}
+
+bool loadCachedAtlas(const std::string& cachePath, uint64_t key, FontAtlas& atlas) {
+	MappedFile& file = atlas.cacheFile;
+	if (!file.open(cachePath)) {
+		return false;
+	}
+	AtlasHeader header;
+	size_t glyphBytes = sizeof(GlyphMetrics) * 128;
+	if (file.size() < sizeof(header) + glyphBytes) {
+		return false;
+	}
+	std::memcpy(&header, file.data(), sizeof(header));
+	if (std::memcmp(header.magic, "SNKF", 4) != 0 || header.version != atlasVersion || header.key != key ||
+		header.width <= 0 || header.height <= 0 ||
+		file.size() != sizeof(header) + glyphBytes + static_cast<size_t>(header.width) * header.height) {
+		file.close();
+		return false;
+	}
+	atlas.width = header.width;
+	atlas.height = header.height;
+	std::memcpy(atlas.glyphs.data(), file.data() + sizeof(header), glyphBytes);
+	atlas.pixels = file.data() + sizeof(header) + glyphBytes;
+	return true;
+}
+
+void saveCachedAtlas(const std::string& cachePath, uint64_t key, const FontAtlas& atlas) {
+	std::ofstream file(cachePath, std::ios::binary);
+	if (!file.is_open()) {
+		return;
+	}
+	AtlasHeader header;
+	std::memcpy(header.magic, "SNKF", 4);
+	header.version = atlasVersion;
+	header.key = key;
+	header.width = atlas.width;
+	header.height = atlas.height;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(atlas.glyphs.data()), sizeof(GlyphMetrics) * 128);
+	file.write(reinterpret_cast<const char*>(atlas.pixels), static_cast<std::streamsize>(atlas.width) * atlas.height);
+}
+
+} // namespace
+
+std::unique_ptr<FontAtlas> loadFontAtlas(const std::string& fontPath, int fontSize) {
+	MappedFile font;
+	if (!font.open(fontPath)) {
+		std::cerr << "ERROR: Failed to load font" << std::endl;
+		return nullptr;
+	}
+
+	uint64_t key = hashSeed;
+	hashBytes(key, fontPath.data(), fontPath.size());
+	hashBytes(key, &fontSize, sizeof(fontSize));
+	hashBytes(key, font.data(), font.size());
+
+	char fileName[64];
+	std::snprintf(fileName, sizeof(fileName), "fontcache_%016llx.bin", static_cast<unsigned long long>(key));
+	std::string cachePath = cacheFilePath(fileName);
+
+	auto atlas = std::unique_ptr<FontAtlas>(new FontAtlas());
+	if (loadCachedAtlas(cachePath, key, *atlas)) {
+		std::cout << "Font atlas loaded from cache: " << cachePath << std::endl;
+		return atlas;
+	}
+
+	atlas = bakeAtlas(font, fontSize);
+	if (atlas) {
+		std::cout << "Font rasterized: " << fontPath << std::endl;
+		saveCachedAtlas(cachePath, key, *atlas);
+	}
+	return atlas;
+}
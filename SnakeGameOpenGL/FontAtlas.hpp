@@ -0,0 +1,34 @@
+#pragma once
+#include "MappedFile.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Placement and metrics of one glyph in the atlas, in pixels. Stored as is
+// in the cache file.
+struct GlyphMetrics {
+	int32_t width, height;
+	int32_t bearingX, bearingY;
+	int32_t x, y;     // top-left corner in the atlas
+	uint32_t advance; // 1/64 pixels, as FreeType reports it
+};
+
+// Single-channel atlas holding ASCII 0-127, ready for glTexImage2D. When it
+// came from the cache, `pixels` points into the memory-mapped file.
+struct FontAtlas {
+	int width = 0, height = 0;
+	std::array<GlyphMetrics, 128> glyphs{};
+	const uint8_t* pixels = nullptr;
+
+	std::vector<uint8_t> bakedPixels; // storage after a cold start
+	MappedFile cacheFile;             // storage after a warm start
+};
+
+// Loads the atlas for a font and pixel size from fontcache_<key>.bin, where
+// the key hashes the font path, size and font file contents. On a miss the
+// glyphs are rasterized by FreeType on several threads, each with its own
+// FT_Library, and the result is written to the cache. Returns null when the
+// font cannot be loaded. Safe to call from a worker thread.
+std::unique_ptr<FontAtlas> loadFontAtlas(const std::string& fontPath, int fontSize);
@@ -0,0 +1,40 @@
+#include "FreeCellSet.hpp"
+#include <cstring>
+
+FreeCellSet::FreeCellSet(int cellCount):
+	cells(cellCount), slot(cellCount) {
+	reset();
+}
+
+void FreeCellSet::reset() {
+	cells.resize(slot.size());
+	for (int i = 0; i < static_cast<int>(slot.size()); ++i) {
+		cells[i] = i;
+		slot[i] = i;
+	}
+}
+
+void FreeCellSet::occupy(int cell) {
+	int index = slot[cell];
+	if (index < 0) {
+		return;
+	}
+	int last = cells.back();
+	cells[index] = last;
+	slot[last] = index;
+	cells.pop_back();
+	slot[cell] = -1;
+}
+
+void FreeCellSet::release(int cell) {
+	if (slot[cell] >= 0) {
+		return;
+	}
+	slot[cell] = static_cast<int>(cells.size());
+	cells.push_back(cell);
+}
+
+void FreeCellSet::assign(const int* freeList, int freeCount, const int* slots) {
+	cells.assign(freeList, freeList + freeCount);
+	std::memcpy(slot.data(), slots, slot.size() * sizeof(int));
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+#include <random>
+
+// Set of unoccupied board cells with O(1) insert, remove and uniform sampling.
+// Cells live in a dense array; a reverse index maps each cell to its slot so
+// occupying one is a swap-remove and freeing one is an append.
+class FreeCellSet {
+public:
+	explicit FreeCellSet(int cellCount);
+
+	void reset(); // every cell free
+	void occupy(int cell);
+	void release(int cell);
+
+	bool isFree(int cell) const { return slot[cell] >= 0; }
+	bool empty() const { return cells.empty(); }
+	int size() const { return static_cast<int>(cells.size()); }
+
+	// Raw arrays for snapshots: the dense free list and the cell -> slot index
+	const int* cellData() const { return cells.data(); }
+	const int* slotData() const { return slot.data(); }
+	int cellCount() const { return static_cast<int>(slot.size()); }
+	void assign(const int* freeList, int freeCount, const int* slots);
+
+	template <typename Rng>
+	int sample(Rng& rng) const {
+		std::uniform_int_distribution<int> dist(0, size() - 1);
+		return cells[dist(rng)];
+	}
+
+private:
+	std::vector<int> cells; // dense list of free cells
+	std::vector<int> slot;  // cell -> index into cells, -1 when occupied
+};
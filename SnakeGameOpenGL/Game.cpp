@@ -1,22 +1,71 @@
 ﻿#include <iostream>
 #include "Game.hpp"
+#include "Snapshot.hpp"
+#include "BatchRunner.hpp"
+#include "GlExtensions.hpp"
 #include <glad/glad.h>
-
-Game::Game(int width, int height, const std::string& title):
-	width(width), height(height), title(title) {
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+Game::Game(int width, int height, const std::string& title, const GameConfig& config):
+	width(width), height(height), title(title), config(config),
+	gridWidth(config.gridWidth), gridHeight(config.gridHeight),
+	seed(std::random_device{}()),
+	simulation(config.gridWidth, config.gridHeight, seed) {
+	profilerOverlay = config.showProfiler;
+	Profiler::setAllocationCounting(profilerOverlay || !config.tracePath.empty());
+	if (config.autopilot) {
+		autopilot = new Autopilot(config.gridWidth, config.gridHeight);
+	}
+	if (!config.recordPath.empty()) {
+		recorder.begin(simulation, seed);
+	}
 	init();
 }
 
 Game::~Game() {
-	glfwDestroyWindow(window);
-	glfwTerminate();
+	saveRecording();
+	Profiler::get().stopTrace();
+	Profiler::get().shutdownGpu();
+	delete autopilot;
+	autopilot = nullptr;
+	delete board;
+	board = nullptr;
+	delete boardTexture;
+	boardTexture = nullptr;
+	// GL objects go while the context is still alive; headless runs create
+	// several games in one process
+	delete offscreenTarget;
+	offscreenTarget = nullptr;
 	if (renderer) {
 		delete renderer;
 		renderer = nullptr;
 	}
+	if (textRenderer) {
+		textRenderer->clearText();
+		delete textRenderer;
+		textRenderer = nullptr;
+	}
+	delete streamBuffer;
+	streamBuffer = nullptr;
+	glfwDestroyWindow(window);
+	glfwTerminate();
 }
 
+static const char* fontPath = "BitcountGridDouble-VariableFont_CRSV,ELSH,ELXP,slnt,wght.ttf";
+static const int fontSize = 30;
+
 void Game::init() {
+    // Glyphs load on a worker thread while the window and GL come up
+    textRenderer = new TextRenderer();
+    textRenderer->preload(fontPath, fontSize);
+
+    if (config.headless) {
+        // GLFW 3.4+: no display server needed
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    }
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" <<std::endl;
         exit(EXIT_FAILURE);
@@ -25,7 +74,23 @@ void Game::init() {
 		std::cout << "GLFW initialized successfully" << std::endl;
     }
 
-    window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+    if (config.headless) {
+        // Mesa (llvmpipe on GPU-less machines) only exposes 3.3 as a core profile
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+        if (!window) {
+            std::cout << "EGL context unavailable, trying OSMesa" << std::endl;
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+            window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+        }
+    }
+    else {
+        window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+    }
     if (!window) {
         std::cerr << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
@@ -36,7 +101,17 @@ void Game::init() {
     }
 
     glfwMakeContextCurrent(window);
-    glfwSwapInterval(1); // Enable VSync
+    glfwSetWindowUserPointer(window, this);
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow* win, int newWidth, int newHeight) {
+        static_cast<Game*>(glfwGetWindowUserPointer(win))->onResize(newWidth, newHeight);
+    });
+    glfwSetKeyCallback(window, [](GLFWwindow* win, int key, int, int action, int) {
+        static_cast<Game*>(glfwGetWindowUserPointer(win))->onKey(key, action);
+    });
+    glfwSwapInterval(config.pacing == FramePacing::VSync ? 1 : 0);
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow* win) {
+        static_cast<Game*>(glfwGetWindowUserPointer(win))->needsRedraw = true;
+    });
 
     // Load GLAD after context
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
@@ -46,12 +121,27 @@ void Game::init() {
     else {
 		std::cout << "GLAD initialized successfully" << std::endl;
     }
+    loadGlExtensions((GLADloadproc)glfwGetProcAddress);
 
     // Set OpenGL viewport
     glViewport(0, 0, width, height);
 
+    if (config.headless) {
+        offscreenTarget = new RenderTarget(width, height);
+        if (!offscreenTarget->isComplete()) {
+            exit(EXIT_FAILURE);
+        }
+        offscreenTarget->bind();
+    }
+
+    Profiler::get().initGpu();
+    if (!config.tracePath.empty()) {
+        Profiler::get().startTrace(config.tracePath);
+    }
+
 
-    renderer = new Renderer(width, height);
+    streamBuffer = new StreamBuffer();
+    renderer = new Renderer(width, height, *streamBuffer);
 	if (!renderer) {
 		std::cerr << "Failed to create Renderer" << std::endl;
 		glfwDestroyWindow(window);
@@ -61,25 +151,42 @@ void Game::init() {
     else {
 		std::cout << "Renderer created successfully" << std::endl;
     }
+    if (config.boardTexture) {
+        boardTexture = new BoardTexture(gridWidth, gridHeight, glm::vec3(0.15f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        boardTexture->rebuild(simulation);
+    }
+    else {
+        board = new ChunkedBoard(*renderer, gridWidth, gridHeight);
+    }
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
 
-	textRenderer = new TextRenderer();
-    textRenderer->init("BitcountGridDouble-VariableFont_CRSV,ELSH,ELXP,slnt,wght.ttf", 30);
+    textRenderer->init(fontPath, fontSize, *streamBuffer);
+
+    // HUD strings are retained; only the score ones are ever rebuilt
+    scoreText = textRenderer->createText();
+    finalScoreText = textRenderer->createText();
+    gameOverText = textRenderer->createText();
+    restartText = textRenderer->createText();
+    textRenderer->setText(gameOverText, "Game Over!", -0.2f, 0.1f, 0.002f, glm::vec3(1, 0, 0));
+    textRenderer->setText(restartText, "Press R to Restart", -0.3f, -0.1f, 0.002f, glm::vec3(1, 1, 1));
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
 
 
-    snake.clear();
-    for (int i = 0; i < snakeLength; ++i) {
-        snake.push_back(glm::ivec2(10 - i, 10)); // horizontal right
+void Game::onResize(int newWidth, int newHeight) {
+    if (newWidth == 0 || newHeight == 0) {
+        return; // minimized
     }
-
-	spawnFood();
+    width = newWidth;
+    height = newHeight;
+    needsRedraw = true;
+    glViewport(0, 0, width, height);
+    renderer->setViewportSize(width, height);
 }
 
-
 void Game::run() {
     lastFrameTime = glfwGetTime();
 
@@ -88,120 +195,325 @@ void Game::run() {
         deltaTime = currentTime - lastFrameTime;
         lastFrameTime = currentTime;
 
-		update();
-		render();
-		glfwSwapBuffers(window);
-		glfwPollEvents();
+		Profiler& profiler = Profiler::get();
+		profiler.beginFrame();
+		{
+			ProfileScope scope("update");
+			update();
+		}
+		if (config.pacing != FramePacing::OnDemand || needsRedraw) {
+			{
+				ProfileScope scope("render", true);
+				render();
+			}
+			{
+				ProfileScope scope("swap");
+				glfwSwapBuffers(window);
+			}
+			streamBuffer->endFrame();
+			needsRedraw = false;
+		}
+		profiler.endFrame();
+		waitForNextFrame(currentTime);
 	}
 }
 
+void Game::waitForNextFrame(double frameStart) {
+    switch (config.pacing) {
+        case FramePacing::VSync:
+            glfwPollEvents(); // the swap already waited
+            break;
+        case FramePacing::Capped: {
+            glfwPollEvents();
+            // Sleeps overshoot by up to a scheduler tick, so sleep until
+            // shortly before the deadline and spin the rest
+            double target = frameStart + 1.0 / std::max(1, config.fpsCap);
+            double remaining = target - glfwGetTime();
+            if (remaining > 0.002) {
+                std::this_thread::sleep_for(std::chrono::duration<double>(remaining - 0.002));
+            }
+            while (glfwGetTime() < target) {
+                std::this_thread::yield();
+            }
+            break;
+        }
+        case FramePacing::OnDemand: {
+            // Nothing moves between ticks, so block until the next one is due
+            // or an event arrives; with no game running only events matter
+            double timeout = simulation.getState() == GameState::Playing ? std::max(0.0, moveDelay - moveTimer) : 0.5;
+            glfwWaitEventsTimeout(timeout);
+            break;
+        }
+    }
+}
+
+RenderBenchResult Game::runOffscreen(int frames) {
+    Profiler& profiler = Profiler::get();
+    RenderBenchResult result;
+    deltaTime = 1.0 / 60.0;
+
+    double start = glfwGetTime();
+    for (int frame = 0; frame < frames; ++frame) {
+        profiler.beginFrame();
+        {
+            ProfileScope scope("update");
+            if (simulation.getState() == GameState::GameOver) {
+                restartGame();
+            }
+            simulation.applyCommand(steerTowardFood(simulation));
+            update();
+        }
+        {
+            ProfileScope scope("render", true);
+            render();
+        }
+        {
+            // Nothing to present; wait for the frame instead so the GPU work
+            // is part of the measurement
+            ProfileScope scope("finish");
+            glFinish();
+        }
+        streamBuffer->endFrame();
+        profiler.endFrame();
+
+        result.drawCallsPerFrame += static_cast<double>(profiler.lastFrameCount(ProfileCounter::DrawCalls));
+        result.uploadsPerFrame += static_cast<double>(profiler.lastFrameCount(ProfileCounter::BufferUploads));
+    }
+    result.seconds = glfwGetTime() - start;
+    result.frames = frames;
+    if (frames > 0) {
+        result.drawCallsPerFrame /= frames;
+        result.uploadsPerFrame /= frames;
+    }
+    return result;
+}
+
 void Game::update() {
 	// TODO: input and logic
-    if (state == GameState::GameOver) {
-        if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS) {
+    updateQuickSave();
+
+    bool profilerPressed = glfwGetKey(window, GLFW_KEY_F3) == GLFW_PRESS;
+    if (profilerPressed && !profilerKeyHeld) {
+        profilerOverlay = !profilerOverlay;
+        Profiler::setAllocationCounting(profilerOverlay || !config.tracePath.empty());
+    }
+    profilerKeyHeld = profilerPressed;
+
+    if (simulation.getState() == GameState::GameOver) {
+        if (autopilot || glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS) {
             restartGame();
         }
         return;
     }
 
-    updateDirection();
-
-    moveTimer += static_cast<float>(deltaTime); // assume ~60 FPS for now, use deltaTime later
+    moveTimer += deltaTime;
 
-    if (moveTimer >= moveDelay) {
-        moveTimer = 0.0f;
+    int ticks = 0;
+    while (moveTimer >= moveDelay && ticks < maxCatchUpTicks) {
+        moveTimer -= moveDelay;
+        ++ticks;
         updateSnake();
+        if (simulation.getState() == GameState::GameOver) {
+            moveTimer = 0.0;
+            return;
+        }
     }
 
+    // Too far behind (e.g. the window was dragged): drop the backlog instead of
+    // fast-forwarding the snake, but keep the phase
+    if (moveTimer >= moveDelay) {
+        moveTimer = std::fmod(moveTimer, moveDelay);
+    }
 }
 
 void Game::restartGame() {
-	snake.clear();
-	snakeLength = 1;
-	for (int i = 0; i < snakeLength; ++i) {
-		snake.push_back(glm::ivec2(10 - i, 10)); // horizontal right
+	saveRecording();
+
+	// Fresh seed per game so every recording starts from a known state
+	seed = std::random_device{}();
+	simulation.reseed(seed);
+	simulation.applyCommand(Command::Restart);
+	if (!config.recordPath.empty()) {
+		recorder.begin(simulation, seed);
 	}
-	spawnFood();
-	score = 0;
-	state = GameState::Playing;
-	snakeDirection = Direction::RIGHT;
-	moveTimer = 0.0f;
+	resetBoardCache();
+	moveTimer = 0.0;
+	clearInput();
 	std::cout << "Game restarted!" << std::endl;
 	glfwSetWindowShouldClose(window, false);
-    render();
 }
 
-void Game::updateSnake() {
-    glm::ivec2 newHead = snake.front();
+void Game::resetBoardCache() {
+	if (board) {
+		board->markAllDirty();
+	}
+	if (boardTexture) {
+		boardTexture->rebuild(simulation);
+	}
+}
+
+void Game::updateQuickSave() {
+    const char* path = "quicksave.snap";
 
-    switch (snakeDirection) {
-        case Direction::UP:    newHead.y += 1; break;
-        case Direction::DOWN:  newHead.y -= 1; break;
-        case Direction::LEFT:  newHead.x -= 1; break;
-        case Direction::RIGHT: newHead.x += 1; break;
+    bool savePressed = glfwGetKey(window, GLFW_KEY_F5) == GLFW_PRESS;
+    if (savePressed && !quickSaveHeld && saveSnapshot(path, simulation, moveTimer)) {
+        std::cout << "Quicksaved: " << path << std::endl;
+    }
+    quickSaveHeld = savePressed;
+
+    bool loadPressed = glfwGetKey(window, GLFW_KEY_F9) == GLFW_PRESS;
+    if (loadPressed && !quickLoadHeld) {
+        // The recording so far no longer leads to the restored state; keep it
+        // as a finished game and start recording again on the next restart
+        saveRecording();
+        if (loadSnapshot(path, simulation, &moveTimer)) {
+            resetBoardCache();
+            clearInput();
+            std::cout << "Quickloaded: " << path << std::endl;
+        }
     }
+    quickLoadHeld = loadPressed;
+}
 
-    // Wrap around
-    newHead.x = (newHead.x + gridWidth) % gridWidth;
-    newHead.y = (newHead.y + gridHeight) % gridHeight;
+void Game::updateSnake() {
+    needsRedraw = true;
+    if (autopilot) {
+        // Decided per tick so catch-up ticks get their own decisions; the
+        // keyboard is ignored
+        bufferedTurns = 0;
+        simulation.applyCommand(autopilot->decide(simulation));
+    }
+    else {
+        applyBufferedTurn();
+    }
+    recorder.beforeTick(simulation);
+    TickEvent event = simulation.tick();
+
+    // The old head became body and the tail moved on, vacating a cell; those
+    // are the only cells whose cached chunk geometry can change
+    const SnakeBody& snake = simulation.getSnake();
+    if (event != TickEvent::Died && board && snake.size() > 1) {
+        board->markDirty(snake[1]);
+        board->markDirty(snake.back());
+        board->markDirty(simulation.cellIndex(simulation.getPreviousTail()));
+    }
+    if (event != TickEvent::Died && boardTexture) {
+        boardTexture->update(simulation);
+    }
 
-    // Check collision with self
-    if (std::find(snake.begin(), snake.end(), newHead) != snake.end()) {
-        std::cout << "Game Over! Final Score: " << score << std::endl;
-		state = GameState::GameOver;
+    switch (event) {
+        case TickEvent::FoodEaten:
+            std::cout << "Food eaten! Score: " << simulation.getScore() << std::endl;
+            break;
+        case TickEvent::Died:
+            std::cout << "Game Over! Final Score: " << simulation.getScore() << std::endl;
+            if (latencyCount > 0) {
+                std::cout << "Input latency (key poll to turn): avg " << latencySum / latencyCount * 1000.0
+                    << " ms, max " << latencyMax * 1000.0 << " ms over " << latencyCount << " turns" << std::endl;
+            }
+            saveRecording();
+            break;
+        case TickEvent::None:
+            break;
     }
+}
 
-    // Insert new head
-    snake.push_front(newHead);
+void Game::saveRecording() {
+    if (!recorder.isActive()) {
+        return;
+    }
+    recorder.finish(simulation);
+    if (recorder.getReplay().save(config.recordPath)) {
+        std::cout << "Replay saved: " << config.recordPath << " (" << recorder.getReplay().events.size() << " turns)" << std::endl;
+    }
+}
 
-    // Check if food eaten
-    if (newHead == foodPosition) {
-        snakeLength++;
-        score += 5;
-        std::cout << "Food eaten! Score: " << score << std::endl;
-        spawnFood();
+void Game::onKey(int key, int action) {
+    needsRedraw = true;
+    if (action != GLFW_PRESS) {
+        return; // auto-repeat would only queue the same turn again
+    }
+    Command command = Command::None;
+    switch (key) {
+        case GLFW_KEY_W: case GLFW_KEY_UP:    command = Command::TurnUp; break;
+        case GLFW_KEY_S: case GLFW_KEY_DOWN:  command = Command::TurnDown; break;
+        case GLFW_KEY_A: case GLFW_KEY_LEFT:  command = Command::TurnLeft; break;
+        case GLFW_KEY_D: case GLFW_KEY_RIGHT: command = Command::TurnRight; break;
+        default: return;
     }
+    // Once the buffer is full further presses are dropped, there is no use
+    // in queueing more turns than that
+    if (bufferedTurns < static_cast<int>(turnBuffer.size())) {
+        turnBuffer[bufferedTurns++] = { command, glfwGetTime() };
+    }
+}
 
-    // Trim tail
-    while (snake.size() > snakeLength) {
-        snake.pop_back();
+void Game::applyBufferedTurn() {
+    // Apply the oldest turn that actually changes direction; reversals and
+    // repeats of the current direction are discarded so they do not hold up
+    // the turns behind them
+    while (bufferedTurns > 0) {
+        KeyPress press = turnBuffer[0];
+        std::copy(turnBuffer.begin() + 1, turnBuffer.begin() + bufferedTurns, turnBuffer.begin());
+        --bufferedTurns;
+
+        Direction before = simulation.getDirection();
+        simulation.applyCommand(press.command);
+        if (simulation.getDirection() != before) {
+            double latency = glfwGetTime() - press.time;
+            latencySum += latency;
+            latencyMax = std::max(latencyMax, latency);
+            ++latencyCount;
+            return;
+        }
     }
 }
 
-void Game::updateDirection() {
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS && snakeDirection != Direction::DOWN)
-        snakeDirection = Direction::UP;
-    else if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS && snakeDirection != Direction::UP)
-        snakeDirection = Direction::DOWN;
-    else if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS && snakeDirection != Direction::RIGHT)
-        snakeDirection = Direction::LEFT;
-    else if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS && snakeDirection != Direction::LEFT)
-        snakeDirection = Direction::RIGHT;
+void Game::clearInput() {
+    bufferedTurns = 0;
+    latencySum = 0.0;
+    latencyMax = 0.0;
+    latencyCount = 0;
 }
 
-void Game::drawGrid() {
-    float cellWidth = 2.0f / gridWidth;
-    float cellHeight = 2.0f / gridHeight;
+void Game::drawGrid(glm::vec2 viewMin) {
+    // The background never changes, so it is baked once and redrawn with one
+    // call. Boards that fit the view bake every cell; bigger ones bake a
+    // view-sized patch that is shifted along with the camera.
+    bool fitsView = gridWidth <= config.viewCells && gridHeight <= config.viewCells;
+    int bakedWidth = fitsView ? gridWidth : config.viewCells + 2;
+    int bakedHeight = fitsView ? gridHeight : config.viewCells + 2;
+    if (!renderer->isGridBaked(bakedWidth, bakedHeight)) {
+        renderer->bakeGrid(bakedWidth, bakedHeight, glm::vec3(0.15f));  // dark gray
+    }
+    glm::vec2 offset = fitsView ? glm::vec2(0.0f) : glm::vec2(std::floor(viewMin.x), std::floor(viewMin.y));
+    renderer->drawBakedGrid(offset);
+}
 
-    for (int y = 0; y < gridHeight; ++y) {
-        for (int x = 0; x < gridWidth; ++x) {
-            float screenX = -1.0f + x * cellWidth;
-            float screenY = -1.0f + y * cellHeight;
 
-            glm::vec3 cellColor = glm::vec3(0.15f);  // dark gray
-            renderer->drawRectangle(screenX, screenY, cellWidth, cellHeight, cellColor);
-        }
-    }
+glm::vec2 Game::interpolatedSegment(size_t index, float alpha) const {
+    // Each segment moved from where the next one is now (or from the vacated
+    // tail for the last segment) to where it is now
+    const auto& snake = simulation.getSnake();
+    glm::ivec2 to = simulation.cellPosition(snake[index]);
+    glm::ivec2 from = index + 1 < snake.size() ? simulation.cellPosition(snake[index + 1]) : simulation.getPreviousTail();
+
+    // Take the short way round when the move wrapped across an edge
+    glm::ivec2 delta = to - from;
+    if (delta.x > 1) delta.x -= gridWidth;
+    if (delta.x < -1) delta.x += gridWidth;
+    if (delta.y > 1) delta.y -= gridHeight;
+    if (delta.y < -1) delta.y += gridHeight;
+
+    float back = 1.0f - alpha;
+    return glm::vec2(to.x - delta.x * back, to.y - delta.y * back);
 }
 
-void Game::spawnFood() {
-    std::mt19937 rng(std::random_device{}());
-    std::uniform_int_distribution<int> xDist(0, gridWidth - 1);
-    std::uniform_int_distribution<int> yDist(0, gridHeight - 1);
 
-    do {
-        foodPosition = glm::ivec2(xDist(rng), yDist(rng));
-    } while (std::find(snake.begin(), snake.end(), foodPosition) != snake.end());
+glm::vec2 Game::nearestCopy(glm::vec2 position, glm::vec2 center) const {
+    position.x += std::round((center.x - position.x) / gridWidth) * gridWidth;
+    position.y += std::round((center.y - position.y) / gridHeight) * gridHeight;
+    return position;
 }
 
 
@@ -211,33 +523,110 @@ void Game::render() {
     glClear(GL_COLOR_BUFFER_BIT);
 
 
+    GameState state = simulation.getState();
+    updateHudText();
+
+    // Camera: small boards are shown whole, larger ones follow the head.
+    // On-demand frames are only drawn on ticks, so they show the tick state
+    // rather than a blend
+    float alpha = config.pacing == FramePacing::OnDemand ? 1.0f : static_cast<float>(moveTimer / moveDelay);
+    glm::vec2 head = interpolatedSegment(0, alpha);
+    bool fitsView = gridWidth <= config.viewCells && gridHeight <= config.viewCells;
+    glm::vec2 extent = fitsView ? glm::vec2(float(gridWidth), float(gridHeight)) : glm::vec2(float(config.viewCells));
+    glm::vec2 center = fitsView ? glm::vec2(extent.x * 0.5f, extent.y * 0.5f) : glm::vec2(head.x + 0.5f, head.y + 0.5f);
+    glm::vec2 viewMin(center.x - extent.x * 0.5f, center.y - extent.y * 0.5f);
+    glm::vec2 viewMax(center.x + extent.x * 0.5f, center.y + extent.y * 0.5f);
+    renderer->setView(center, extent);
+
     //render the grid 
-    drawGrid();
+    {
+        ProfileScope scope("grid", true);
+        if (boardTexture) {
+            // Grid, body and food in one pass; the whole view when it scrolls
+            // (wrapped copies repeat), otherwise just the board
+            glm::vec2 rectMin = fitsView ? glm::vec2(0.0f) : viewMin;
+            glm::vec2 rectMax = fitsView ? extent : viewMax;
+            if (state == GameState::Playing) {
+                boardTexture->draw(*renderer, rectMin, rectMax);
+            }
+            else {
+                drawGrid(viewMin);
+            }
+        }
+        else {
+            drawGrid(viewMin);
+        }
+    }
+    renderer->beginBatch();
 
     if (state == GameState::Playing) {
-        // Display score
-        textRenderer->drawText("Score: " + std::to_string(score), -0.95f, 0.9f, 0.002f, glm::vec3(1.0f));
-
+        glm::vec3 snakeColor(0.0f, 1.0f, 0.0f);
 
-        //render snake head 
-        float cw = 2.0f / gridWidth;
-        float ch = 2.0f / gridHeight;
+        if (board) {
+            // Snake body from the cached chunks in view
+            board->draw(simulation, viewMin, viewMax, snakeColor);
 
-        // Draw food
-        float fx = -1.0f + foodPosition.x * cw;
-        float fy = -1.0f + foodPosition.y * ch;
-        renderer->drawRectangle(fx, fy, cw, ch, glm::vec3(1.0f, 0.0f, 0.0f));
+            // Draw food
+            glm::ivec2 foodPosition = simulation.getFood();
+            glm::vec2 food = nearestCopy(glm::vec2(float(foodPosition.x), float(foodPosition.y)), center);
+            renderer->submitCircle(food.x + 0.5f, food.y + 0.5f, 0.4f, glm::vec3(1.0f, 0.0f, 0.0f));
+        }
 
-        // Draw snake
-        for (const auto& segment : snake) {
-            float sx = -1.0f + segment.x * cw;
-            float sy = -1.0f + segment.y * ch;
-            renderer->drawRectangle(sx, sy, cw, ch, glm::vec3(0.0f, 1.0f, 0.0f));
+        // Head and tail are blended between the previous and the current tick.
+        // The static body includes the tail cell, so the tail quad sliding in
+        // from the vacated cell only ever adds to it; the head slides out of
+        // the cached neck cell. Both are rounded so the snake's ends read as ends.
+        renderer->submitQuad(head.x, head.y, 1.0f, 1.0f, snakeColor, 0.5f);
+        size_t segments = simulation.getSnake().size();
+        if (segments > 1) {
+            glm::vec2 tail = nearestCopy(interpolatedSegment(segments - 1, alpha), center);
+            renderer->submitQuad(tail.x, tail.y, 1.0f, 1.0f, snakeColor, 0.5f);
         }
     }
+
+    // Food, head and tail in one draw call
+    renderer->flushBatch();
+
+    ProfileScope textScope("text", true);
+    if (state == GameState::Playing) {
+        // Display score
+        textRenderer->drawText(scoreText);
+    }
     else if (state == GameState::GameOver) {
-        textRenderer->drawText("Game Over!", -0.2f, 0.1f, 0.002f, glm::vec3(1, 0, 0));
-        textRenderer->drawText("Press R to Restart", -0.3f, -0.1f, 0.002f, glm::vec3(1, 1, 1));
-        textRenderer->drawText("Score: " + std::to_string(score), -0.2f, -0.3f, 0.002f, glm::vec3(1, 1, 0));
+        textRenderer->drawText(gameOverText);
+        textRenderer->drawText(restartText);
+        textRenderer->drawText(finalScoreText);
     }
+
+    if (profilerOverlay) {
+        drawProfilerOverlay();
+    }
+}
+
+void Game::drawProfilerOverlay() {
+    double now = glfwGetTime();
+    if (now >= profilerRefreshTime) {
+        Profiler::get().overlayLines(profilerLines);
+        profilerRefreshTime = now + 0.25;
+    }
+
+    textRenderer->beginText();
+    float y = 0.8f;
+    for (const auto& line : profilerLines) {
+        textRenderer->queueText(line, -0.95f, y, 0.0012f, glm::vec3(0.9f, 0.9f, 0.5f));
+        y -= 0.06f;
+    }
+    textRenderer->flushText();
+}
+
+void Game::updateHudText() {
+    int score = simulation.getScore();
+    if (score == displayedScore) {
+        return;
+    }
+    displayedScore = score;
+
+    std::string scoreLabel = "Score: " + std::to_string(score);
+    textRenderer->setText(scoreText, scoreLabel, -0.95f, 0.9f, 0.002f, glm::vec3(1.0f));
+    textRenderer->setText(finalScoreText, scoreLabel, -0.2f, -0.3f, 0.002f, glm::vec3(1, 1, 0));
 }
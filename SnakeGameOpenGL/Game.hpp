@@ -4,20 +4,64 @@
 #include <string>
 #include "Renderer.hpp"
 #include "TextRenderer.hpp"
-#include <deque>
+#include "Simulation.hpp"
+#include "ChunkedBoard.hpp"
+#include "BoardTexture.hpp"
+#include "Replay.hpp"
+#include "Autopilot.hpp"
+#include "Profiler.hpp"
+#include "RenderTarget.hpp"
+#include <array>
 #include <random>
+#include <vector>
 
-enum class Direction { UP, DOWN, LEFT, RIGHT };
-enum class GameState { Playing, GameOver };
+// How the main loop paces frames
+enum class FramePacing {
+	VSync,   // swap interval 1, the swap blocks until the next refresh
+	Capped,  // swap interval 0, sleep then spin up to 1 / fpsCap per frame
+	OnDemand // draw only after a tick or an input/resize event, sleep in glfwWaitEventsTimeout until the next tick
+};
+
+// Launch options, filled in from the command line by main()
+struct GameConfig {
+	int gridWidth = 20;
+	int gridHeight = 20;
+	int viewCells = 40; // boards larger than this scroll with the head
+	std::string recordPath; // when set, each game is recorded here as a replay
+	std::string tracePath;  // when set, a Chrome trace of the session is written here on exit
+	bool showProfiler = false; // start with the stats overlay (F3) visible
+	// No window: a hidden GL 3.3 context from EGL (surfaceless) or OSMesa on
+	// GLFW's null platform, rendering into an offscreen framebuffer. Drive it
+	// with runOffscreen() instead of run().
+	bool headless = false;
+	FramePacing pacing = FramePacing::VSync;
+	int fpsCap = 144; // for FramePacing::Capped
+	// Draw the grid, body and food from a cell-state texture in one pass
+	// (BoardTexture) instead of the chunked instance layers
+	bool boardTexture = false;
+	// The Autopilot plays instead of the keyboard and restarts finished
+	// games, for soak tests and demos
+	bool autopilot = false;
+};
+
+struct RenderBenchResult {
+	int frames = 0;
+	double seconds = 0.0;
+	double drawCallsPerFrame = 0.0;
+	double uploadsPerFrame = 0.0;
+
+	double framesPerSecond() const { return seconds > 0.0 ? frames / seconds : 0.0; }
+};
 
 class Game {
 public:
-	Game(int width, int height, const std::string& title);
+	Game(int width, int height, const std::string& title, const GameConfig& config = GameConfig());
 	~Game();
 
 	void run();
-	int score = 0;
-	GameState state = GameState::Playing;
+	// Renders `frames` frames as fast as possible with a fixed 60 Hz time step,
+	// the snake steered by a bot and restarted when it dies
+	RenderBenchResult runOffscreen(int frames);
 
 private:
 	GLFWwindow* window;
@@ -25,32 +69,79 @@ private:
 	std::string title;
 	Renderer* renderer;
 	TextRenderer* textRenderer;
+	ChunkedBoard* board = nullptr;          // exactly one of these two is
+	BoardTexture* boardTexture = nullptr;   // created, see GameConfig::boardTexture
+	StreamBuffer* streamBuffer = nullptr; // per-frame geometry for both renderers
+	RenderTarget* offscreenTarget = nullptr;
+	GameConfig config;
+
+	TextHandle scoreText, finalScoreText, gameOverText, restartText;
+	int displayedScore = -1; // score the HUD text was last built for
 
 	void init();
+	void onResize(int newWidth, int newHeight);
 	void update();
 	void render();
+	void waitForNextFrame(double frameStart);
+
+	// OnDemand pacing: something visible changed since the last frame
+	bool needsRedraw = true;
 	
 	double lastFrameTime = 0.0;
 	double deltaTime = 0.0;
 
-	
-	glm::ivec2 snakeHead = { 10, 10 };
-	Direction snakeDirection = Direction::RIGHT;
-	std::deque<glm::ivec2> snake;  // body: [head, ..., tail]
-	
-	glm::ivec2 foodPosition;
+	// Fixed-timestep accumulator: leftover time carries over to the next frame
+	// and a slow frame runs several catch-up ticks, up to maxCatchUpTicks.
+	double moveTimer = 0.0;
+	double moveDelay = 0.2; // seconds between moves
+	const int maxCatchUpTicks = 5;
 
-	int snakeLength = 1; // initial length
-	float moveTimer = 0.0f;
-	float moveDelay = 0.2f; // seconds between moves
+	const int gridWidth;
+	const int gridHeight;
 
-	const int gridWidth = 20;
-	const int gridHeight = 20;
+	uint32_t seed; // seed of the current game, for replays
+	Simulation simulation;
+	ReplayRecorder recorder;
+	Autopilot* autopilot = nullptr; // set when GameConfig::autopilot is
 	
+	// Turn keys arrive through the GLFW key callback and wait in a small
+	// buffer so that two quick turns between ticks are applied on
+	// consecutive ticks instead of the second overwriting the first. The
+	// callback runs inside glfwPollEvents on this thread, so the time stamp
+	// (and the latency measured from it) is when the press was polled, not
+	// when the OS saw it.
+	struct KeyPress {
+		Command command;
+		double time;
+	};
+	std::array<KeyPress, 3> turnBuffer;
+	int bufferedTurns = 0;
+
+	// Key poll to the tick that turned the snake, over the current game
+	double latencySum = 0.0, latencyMax = 0.0;
+	int latencyCount = 0;
+
+	void onKey(int key, int action);
+	void applyBufferedTurn();
+	void clearInput();
+
 	// Methods
-	void updateDirection(); // input
 	void updateSnake();     // logic
-	void drawGrid(); // rendering
-	void spawnFood(); // random food position
+	void drawGrid(glm::vec2 viewMin); // rendering
+	glm::vec2 interpolatedSegment(size_t index, float alpha) const;
+	glm::vec2 nearestCopy(glm::vec2 position, glm::vec2 center) const; // wrapped copy closest to the camera
+	void updateHudText();
 	void restartGame();
+	void resetBoardCache(); // after the whole board changed (restart, quickload)
+	void saveRecording();
+
+	// F5 / F9 quicksave and quickload; the flags turn held keys into presses
+	bool quickSaveHeld = false, quickLoadHeld = false;
+	void updateQuickSave();
+
+	// F3 stats overlay, refreshed a few times a second so it stays readable
+	bool profilerOverlay = false, profilerKeyHeld = false;
+	std::vector<std::string> profilerLines;
+	double profilerRefreshTime = 0.0;
+	void drawProfilerOverlay();
 };
@@ -0,0 +1,50 @@
+#include "GlExtensions.hpp"
+#include <cstring>
+
+namespace {
+
+GlExtensions extensions;
+
+bool hasExtension(const char* name) {
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; ++i) {
+		const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+		if (extension && std::strcmp(extension, name) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+template <typename Proc>
+Proc load(GLADloadproc loader, const char* name) {
+	return reinterpret_cast<Proc>(loader(name));
+}
+
+} // namespace
+
+void loadGlExtensions(GLADloadproc loader) {
+	GLint major = 0, minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	int version = major * 10 + minor;
+
+	extensions = GlExtensions();
+
+	if (version >= 44 || hasExtension("GL_ARB_buffer_storage")) {
+		extensions.bufferStorage = load<GlExtensions::BufferStorageProc>(loader, "glBufferStorage");
+		extensions.hasBufferStorage = extensions.bufferStorage != nullptr;
+	}
+
+	if (version >= 41 || hasExtension("GL_ARB_get_program_binary")) {
+		extensions.getProgramBinary = load<GlExtensions::GetProgramBinaryProc>(loader, "glGetProgramBinary");
+		extensions.programBinary = load<GlExtensions::ProgramBinaryProc>(loader, "glProgramBinary");
+		extensions.programParameteri = load<GlExtensions::ProgramParameteriProc>(loader, "glProgramParameteri");
+		extensions.hasProgramBinary = extensions.getProgramBinary && extensions.programBinary && extensions.programParameteri;
+	}
+}
+
+const GlExtensions& glExtensions() {
+	return extensions;
+}
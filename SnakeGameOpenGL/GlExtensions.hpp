@@ -0,0 +1,43 @@
+#pragma once
+#include <glad/glad.h>
+
+// Optional entry points beyond GL 3.3, resolved at runtime from the context
+// instead of through glad, so the build does not depend on which extensions
+// the installed glad was generated with. Each group's pointers are null when the driver
+// lacks it; check the has* flag before calling.
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+struct GlExtensions {
+	typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+	typedef void (APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+	typedef void (APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+	typedef void (APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+	// GL 4.4 or ARB_buffer_storage
+	bool hasBufferStorage = false;
+	BufferStorageProc bufferStorage = nullptr;
+
+	// GL 4.1 or ARB_get_program_binary
+	bool hasProgramBinary = false;
+	GetProgramBinaryProc getProgramBinary = nullptr;
+	ProgramBinaryProc programBinary = nullptr;
+	ProgramParameteriProc programParameteri = nullptr;
+};
+
+// Call once after gladLoadGLLoader, with the same loader
+void loadGlExtensions(GLADloadproc loader);
+const GlExtensions& glExtensions();
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit FNV-1a, shared by the state hashes (replays, arena determinism
+// checks) and the cache file keys. Start from hashSeed and feed data in.
+const uint64_t hashSeed = 14695981039346656037ull;
+
+inline void hashBytes(uint64_t& hash, const void* data, size_t size) {
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+}
+
+// Little endian byte by byte, so hashes match across platforms
+inline void hashWord(uint64_t& hash, uint32_t value) {
+	for (int i = 0; i < 4; ++i) {
+		hash ^= (value >> (i * 8)) & 0xFF;
+		hash *= 1099511628211ull;
+	}
+}
@@ -0,0 +1,149 @@
+#include "HeadBatch.hpp"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HEAD_BATCH_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HEAD_BATCH_SSE2 1
+#endif
+
+namespace {
+
+const int laneGroup = 16;
+
+int paddedCount(int count) {
+	return (count + laneGroup - 1) / laneGroup * laneGroup;
+}
+
+} // namespace
+
+HeadBatch::HeadBatch(int gameCount, int gridWidth, int gridHeight):
+	gridWidth(gridWidth), gridHeight(gridHeight), count(gameCount),
+	headX(paddedCount(gameCount)), headY(paddedCount(gameCount)),
+	dirX(paddedCount(gameCount)), dirY(paddedCount(gameCount)),
+	foodX(paddedCount(gameCount)), foodY(paddedCount(gameCount)),
+	ateFood(paddedCount(gameCount)) {
+}
+
+void stepHeadsScalar(HeadBatch& batch) {
+	int lanes = static_cast<int>(batch.headX.size());
+	for (int i = 0; i < lanes; ++i) {
+		int x = batch.headX[i] + batch.dirX[i];
+		int y = batch.headY[i] + batch.dirY[i];
+
+		// Heads move at most one cell, so wrapping is a compare and add
+		// rather than the modulo in Simulation::tick
+		if (x < 0) x += batch.gridWidth;
+		if (x >= batch.gridWidth) x -= batch.gridWidth;
+		if (y < 0) y += batch.gridHeight;
+		if (y >= batch.gridHeight) y -= batch.gridHeight;
+
+		batch.headX[i] = static_cast<int16_t>(x);
+		batch.headY[i] = static_cast<int16_t>(y);
+		batch.ateFood[i] = (x == batch.foodX[i] && y == batch.foodY[i]) ? -1 : 0;
+	}
+}
+
+#if defined(HEAD_BATCH_SSE2)
+
+static inline __m128i wrapAxis(__m128i value, __m128i size, __m128i maxIndex, __m128i zero) {
+	__m128i below = _mm_cmplt_epi16(value, zero);
+	__m128i above = _mm_cmpgt_epi16(value, maxIndex);
+	value = _mm_add_epi16(value, _mm_and_si128(below, size));
+	return _mm_sub_epi16(value, _mm_and_si128(above, size));
+}
+
+static void stepHeadsSse2(HeadBatch& batch) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i width = _mm_set1_epi16(static_cast<short>(batch.gridWidth));
+	const __m128i height = _mm_set1_epi16(static_cast<short>(batch.gridHeight));
+	const __m128i maxX = _mm_set1_epi16(static_cast<short>(batch.gridWidth - 1));
+	const __m128i maxY = _mm_set1_epi16(static_cast<short>(batch.gridHeight - 1));
+
+	int lanes = static_cast<int>(batch.headX.size());
+	for (int i = 0; i < lanes; i += 8) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&batch.headX[i]));
+		__m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&batch.headY[i]));
+		x = _mm_add_epi16(x, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&batch.dirX[i])));
+		y = _mm_add_epi16(y, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&batch.dirY[i])));
+		x = wrapAxis(x, width, maxX, zero);
+		y = wrapAxis(y, height, maxY, zero);
+
+		__m128i hitX = _mm_cmpeq_epi16(x, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&batch.foodX[i])));
+		__m128i hitY = _mm_cmpeq_epi16(y, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&batch.foodY[i])));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&batch.headX[i]), x);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&batch.headY[i]), y);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&batch.ateFood[i]), _mm_and_si128(hitX, hitY));
+	}
+}
+
+#endif
+
+#if defined(HEAD_BATCH_X86)
+
+// HeadBatchAvx2.cpp, the only file built with AVX2 code generation
+void stepHeadsAvx2(HeadBatch& batch);
+
+// AVX2 needs both the instructions and an OS that saves the YMM registers
+static bool cpuHasAvx2() {
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif
+
+namespace {
+
+struct Kernel {
+	void (*step)(HeadBatch&);
+	const char* name;
+};
+
+Kernel selectKernel() {
+#if defined(HEAD_BATCH_X86)
+	if (cpuHasAvx2()) {
+		return { stepHeadsAvx2, "AVX2 (16 lanes)" };
+	}
+#endif
+#if defined(HEAD_BATCH_SSE2)
+	return { stepHeadsSse2, "SSE2 (8 lanes)" };
+#else
+	return { stepHeadsScalar, "scalar" };
+#endif
+}
+
+// Picked once, on first use
+const Kernel& kernel() {
+	static const Kernel selected = selectKernel();
+	return selected;
+}
+
+} // namespace
+
+void stepHeads(HeadBatch& batch) {
+	kernel().step(batch);
+}
+
+const char* stepHeadsKernelName() {
+	return kernel().name;
+}
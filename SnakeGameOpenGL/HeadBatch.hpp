@@ -0,0 +1,27 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+// Structure-of-arrays head state for many games on boards of the same size,
+// stepped in lockstep. Coordinates are 16-bit so one AVX2 instruction covers
+// 16 games (8 with SSE2); lane arrays are padded to a multiple of 16.
+struct HeadBatch {
+	int gridWidth = 0, gridHeight = 0;
+	int count = 0;
+
+	std::vector<int16_t> headX, headY;
+	std::vector<int16_t> dirX, dirY;   // unit step per tick, from Direction
+	std::vector<int16_t> foodX, foodY;
+	std::vector<int16_t> ateFood;      // -1 where the new head is on the food, else 0
+
+	HeadBatch(int gameCount, int gridWidth, int gridHeight);
+};
+
+// Moves every head one step, wraps it around the board edges and flags food
+// hits. Uses the widest kernel the CPU supports (AVX2, SSE2 or scalar),
+// chosen at runtime on first use; all of them produce identical results.
+void stepHeads(HeadBatch& batch);
+void stepHeadsScalar(HeadBatch& batch);
+
+// Name of the kernel stepHeads dispatches to
+const char* stepHeadsKernelName();
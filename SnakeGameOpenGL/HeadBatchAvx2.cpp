@@ -0,0 +1,48 @@
+#include "HeadBatch.hpp"
+
+// Built with AVX2 enabled (/arch:AVX2 for this file in the project, a target
+// attribute elsewhere) and only called after HeadBatch.cpp has checked the
+// CPU supports it; no other file may use AVX2 code generation
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+#if defined(__GNUC__) && !defined(__AVX2__)
+#define HEAD_BATCH_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define HEAD_BATCH_AVX2_TARGET
+#endif
+
+HEAD_BATCH_AVX2_TARGET static inline __m256i wrapAxis(__m256i value, __m256i size, __m256i maxIndex, __m256i zero) {
+	__m256i below = _mm256_cmpgt_epi16(zero, value);      // value < 0
+	__m256i above = _mm256_cmpgt_epi16(value, maxIndex);  // value >= size
+	value = _mm256_add_epi16(value, _mm256_and_si256(below, size));
+	return _mm256_sub_epi16(value, _mm256_and_si256(above, size));
+}
+
+HEAD_BATCH_AVX2_TARGET void stepHeadsAvx2(HeadBatch& batch) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i width = _mm256_set1_epi16(static_cast<short>(batch.gridWidth));
+	const __m256i height = _mm256_set1_epi16(static_cast<short>(batch.gridHeight));
+	const __m256i maxX = _mm256_set1_epi16(static_cast<short>(batch.gridWidth - 1));
+	const __m256i maxY = _mm256_set1_epi16(static_cast<short>(batch.gridHeight - 1));
+
+	int lanes = static_cast<int>(batch.headX.size());
+	for (int i = 0; i < lanes; i += 16) {
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&batch.headX[i]));
+		__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&batch.headY[i]));
+		x = _mm256_add_epi16(x, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&batch.dirX[i])));
+		y = _mm256_add_epi16(y, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&batch.dirY[i])));
+		x = wrapAxis(x, width, maxX, zero);
+		y = wrapAxis(y, height, maxY, zero);
+
+		__m256i hitX = _mm256_cmpeq_epi16(x, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&batch.foodX[i])));
+		__m256i hitY = _mm256_cmpeq_epi16(y, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&batch.foodY[i])));
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&batch.headX[i]), x);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&batch.headY[i]), y);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&batch.ateFood[i]), _mm256_and_si256(hitX, hitY));
+	}
+}
+
+#endif
@@ -0,0 +1,352 @@
+#include "Profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+
+// Allocation counting. Build with SNAKE_ALLOCATION_HOOK=0 to leave the
+// global operator new alone entirely. Otherwise every form of operator new
+// is replaced, but only counts while Profiler::setAllocationCounting is on
+// (Game turns it on with the profiler), and then into a plain per-thread
+// counter: no shared cache line, so worker pools and benchmarks are not
+// slowed down by each other's allocations. Frames report the render
+// thread's count.
+#ifndef SNAKE_ALLOCATION_HOOK
+#define SNAKE_ALLOCATION_HOOK 1
+#endif
+
+static std::atomic<bool> countAllocations(false);
+static thread_local uint64_t threadAllocations = 0;
+
+#if SNAKE_ALLOCATION_HOOK
+
+static void* allocate(std::size_t size) noexcept {
+	if (countAllocations.load(std::memory_order_relaxed)) {
+		++threadAllocations;
+	}
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+static void* allocateOrThrow(std::size_t size) {
+	while (true) {
+		if (void* memory = allocate(size)) {
+			return memory;
+		}
+		std::new_handler handler = std::get_new_handler();
+		if (!handler) {
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+}
+
+void* operator new(std::size_t size) { return allocateOrThrow(size); }
+void* operator new[](std::size_t size) { return allocateOrThrow(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+
+#if defined(__cpp_aligned_new)
+// Over-aligned forms (C++17 and later only); the memory comes from the
+// platform's aligned allocator and must go back to it
+
+static void* allocateAligned(std::size_t size, std::align_val_t alignment) noexcept {
+	if (countAllocations.load(std::memory_order_relaxed)) {
+		++threadAllocations;
+	}
+	std::size_t align = static_cast<std::size_t>(alignment);
+	if (size == 0) {
+		size = 1;
+	}
+#if defined(_MSC_VER)
+	return _aligned_malloc(size, align);
+#else
+	void* memory = nullptr;
+	return posix_memalign(&memory, std::max(align, sizeof(void*)), size) == 0 ? memory : nullptr;
+#endif
+}
+
+static void freeAligned(void* memory) noexcept {
+#if defined(_MSC_VER)
+	_aligned_free(memory);
+#else
+	std::free(memory);
+#endif
+}
+
+static void* allocateAlignedOrThrow(std::size_t size, std::align_val_t alignment) {
+	while (true) {
+		if (void* memory = allocateAligned(size, alignment)) {
+			return memory;
+		}
+		std::new_handler handler = std::get_new_handler();
+		if (!handler) {
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocateAlignedOrThrow(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocateAlignedOrThrow(size, alignment); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment); }
+
+void operator delete(void* memory, std::align_val_t) noexcept { freeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { freeAligned(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { freeAligned(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { freeAligned(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(memory); }
+
+#endif // __cpp_aligned_new
+
+#endif // SNAKE_ALLOCATION_HOOK
+
+void Profiler::setAllocationCounting(bool enabled) {
+	countAllocations.store(enabled && SNAKE_ALLOCATION_HOOK, std::memory_order_relaxed);
+}
+
+uint64_t Profiler::counters[static_cast<int>(ProfileCounter::Count)] = {};
+
+Profiler& Profiler::get() {
+	static Profiler profiler;
+	return profiler;
+}
+
+void Profiler::initGpu() {
+	// Timestamp queries are core since 3.3; they nest, unlike GL_TIME_ELAPSED
+	gpuTiming = GLAD_GL_VERSION_3_3 != 0;
+	if (!gpuTiming) {
+		std::cout << "Profiler: no timer queries, GPU times disabled" << std::endl;
+	}
+}
+
+void Profiler::shutdownGpu() {
+	for (auto& frame : gpuFrames) {
+		for (auto& query : frame.queries) {
+			glDeleteQueries(1, &query.begin);
+			glDeleteQueries(1, &query.end);
+		}
+		frame.queries.clear();
+		frame.used = 0;
+	}
+	gpuTiming = false;
+}
+
+int Profiler::findScope(const char* name) {
+	// A handful of scopes, so a linear search; pointers first since names are
+	// almost always the same string literal
+	for (size_t i = 0; i < scopes.size(); ++i) {
+		if (scopes[i].name == name || std::strcmp(scopes[i].name, name) == 0) {
+			return static_cast<int>(i);
+		}
+	}
+	ScopeStats stats;
+	stats.name = name;
+	scopes.push_back(stats);
+	return static_cast<int>(scopes.size() - 1);
+}
+
+void Profiler::beginFrame() {
+	frameStart = Clock::now();
+	allocationsAtFrameStart = threadAllocations;
+
+	// Reuse the oldest query set; its results are gpuLatency frames old, so
+	// reading them back does not stall the pipeline
+	if (gpuTiming) {
+		GpuFrame& frame = gpuFrames[gpuFrameIndex];
+		collectGpuFrame(frame);
+		frame.used = 0;
+	}
+}
+
+void Profiler::beginScope(const char* name, bool gpu) {
+	OpenScope scope;
+	scope.stats = findScope(name);
+	scope.gpuQuery = -1;
+	if (gpu && gpuTiming) {
+		GpuFrame& frame = gpuFrames[gpuFrameIndex];
+		if (frame.used == frame.queries.size()) {
+			GpuQuery query;
+			glGenQueries(1, &query.begin);
+			glGenQueries(1, &query.end);
+			frame.queries.push_back(query);
+		}
+		scope.gpuQuery = static_cast<int>(frame.used++);
+		GpuQuery& query = frame.queries[scope.gpuQuery];
+		query.stats = scope.stats;
+		glQueryCounter(query.begin, GL_TIMESTAMP);
+	}
+	scope.start = Clock::now();
+	openScopes.push_back(scope);
+}
+
+void Profiler::endScope() {
+	Clock::time_point end = Clock::now();
+	OpenScope scope = openScopes.back();
+	openScopes.pop_back();
+
+	if (scope.gpuQuery >= 0) {
+		glQueryCounter(gpuFrames[gpuFrameIndex].queries[scope.gpuQuery].end, GL_TIMESTAMP);
+	}
+
+	scopes[scope.stats].cpuFrame += std::chrono::duration<double, std::milli>(end - scope.start).count();
+	if (tracing) {
+		double start = sinceTraceStart(scope.start);
+		traceEvents.push_back({ scopes[scope.stats].name, start, sinceTraceStart(end) - start, 1 });
+	}
+}
+
+void Profiler::collectGpuFrame(GpuFrame& frame) {
+	if (frame.used == 0) {
+		return;
+	}
+	// Results arrive in order, so if the last one is in they all are;
+	// otherwise this frame's GPU times are dropped rather than waited for
+	GLint available = 0;
+	glGetQueryObjectiv(frame.queries[frame.used - 1].end, GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available) {
+		return;
+	}
+	for (size_t i = 0; i < frame.used; ++i) {
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(frame.queries[i].begin, GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(frame.queries[i].end, GL_QUERY_RESULT, &end);
+		ScopeStats& stats = scopes[frame.queries[i].stats];
+		stats.gpuFrame += (end - begin) / 1e6;
+		if (tracing) {
+			double start = (static_cast<int64_t>(begin) - gpuClockOffset) / 1e3;
+			traceEvents.push_back({ stats.name, start, (end - begin) / 1e3, 2 });
+		}
+	}
+}
+
+void Profiler::endFrame() {
+	int slot = static_cast<int>(frameNumber % historyFrames);
+	double frameTime = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+
+	for (auto& stats : scopes) {
+		stats.cpuSum += stats.cpuFrame - stats.cpuHistory[slot];
+		stats.gpuSum += stats.gpuFrame - stats.gpuHistory[slot];
+		stats.cpuHistory[slot] = stats.cpuFrame;
+		stats.gpuHistory[slot] = stats.gpuFrame;
+		stats.cpuFrame = 0.0;
+		stats.gpuFrame = 0.0;
+	}
+
+	counters[static_cast<int>(ProfileCounter::Allocations)] =
+		threadAllocations - allocationsAtFrameStart;
+	for (int i = 0; i < static_cast<int>(ProfileCounter::Count); ++i) {
+		counterHistory[slot][i] = counters[i];
+	}
+	frameHistory[slot] = frameTime;
+
+	if (tracing) {
+		char args[192];
+		std::snprintf(args, sizeof(args), "{\"draws\":%llu,\"uniforms\":%llu,\"uploads\":%llu,\"allocs\":%llu,\"binds\":%llu}",
+			static_cast<unsigned long long>(counters[0]), static_cast<unsigned long long>(counters[1]),
+			static_cast<unsigned long long>(counters[2]), static_cast<unsigned long long>(counters[3]),
+			static_cast<unsigned long long>(counters[4]));
+		traceCounters.push_back({ sinceTraceStart(Clock::now()), args });
+	}
+
+	std::fill(std::begin(counters), std::end(counters), uint64_t(0));
+	gpuFrameIndex = (gpuFrameIndex + 1) % gpuLatency;
+	++frameNumber;
+}
+
+double Profiler::sinceTraceStart(Clock::time_point time) const {
+	return std::chrono::duration<double, std::micro>(time - traceStart).count();
+}
+
+void Profiler::startTrace(const std::string& path) {
+	tracePath = path;
+	traceStart = Clock::now();
+	traceEvents.clear();
+	traceCounters.clear();
+	tracing = true;
+
+	// Line the GPU clock up with the CPU one so both tracks share a timeline
+	if (gpuTiming) {
+		GLint64 gpuNow = 0;
+		glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+		gpuClockOffset = gpuNow - static_cast<int64_t>(sinceTraceStart(Clock::now()) * 1e3);
+	}
+}
+
+void Profiler::stopTrace() {
+	if (!tracing) {
+		return;
+	}
+	tracing = false;
+
+	std::ofstream file(tracePath);
+	if (!file.is_open()) {
+		std::cerr << "Failed to write trace: " << tracePath << std::endl;
+		return;
+	}
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+	char line[256];
+	for (const auto& event : traceEvents) {
+		std::snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+			event.name, event.thread, event.start, event.duration);
+		file << line;
+	}
+	for (const auto& counter : traceCounters) {
+		std::snprintf(line, sizeof(line), ",\n{\"name\":\"frame\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"args\":%s}",
+			counter.time, counter.args.c_str());
+		file << line;
+	}
+	file << "\n]}\n";
+	std::cout << "Trace written: " << tracePath << " (" << traceEvents.size() << " events)" << std::endl;
+}
+
+void Profiler::overlayLines(std::vector<std::string>& lines) const {
+	lines.clear();
+	int frames = static_cast<int>(std::min<uint64_t>(frameNumber, historyFrames));
+	if (frames == 0) {
+		return;
+	}
+
+	char line[128];
+	double frameSum = 0.0;
+	for (int i = 0; i < frames; ++i) {
+		frameSum += frameHistory[i];
+	}
+	double frameMs = frameSum / frames;
+	std::snprintf(line, sizeof(line), "frame %.2f ms (%.0f fps)", frameMs, frameMs > 0.0 ? 1000.0 / frameMs : 0.0);
+	lines.push_back(line);
+
+	for (const auto& stats : scopes) {
+		if (gpuTiming && stats.gpuSum > 0.0) {
+			std::snprintf(line, sizeof(line), "%-8s cpu %.2f gpu %.2f ms", stats.name, stats.cpuSum / frames, stats.gpuSum / frames);
+		}
+		else {
+			std::snprintf(line, sizeof(line), "%-8s cpu %.2f ms", stats.name, stats.cpuSum / frames);
+		}
+		lines.push_back(line);
+	}
+
+	double totals[static_cast<int>(ProfileCounter::Count)] = {};
+	for (int i = 0; i < frames; ++i) {
+		for (int c = 0; c < static_cast<int>(ProfileCounter::Count); ++c) {
+			totals[c] += static_cast<double>(counterHistory[i][c]);
+		}
+	}
+	std::snprintf(line, sizeof(line), "draws %.0f binds %.0f uniforms %.0f uploads %.0f allocs %.1f",
+		totals[0] / frames, totals[4] / frames, totals[1] / frames, totals[2] / frames, totals[3] / frames);
+	lines.push_back(line);
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <glad/glad.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-frame counters. The renderers bump the GL ones at each call of the
+// matching kind; Allocations is counted by the global operator new on the
+// render thread, while setAllocationCounting is on.
+enum class ProfileCounter { DrawCalls, UniformUploads, BufferUploads, Allocations, ProgramBinds, Count };
+
+// Frame profiler: scoped CPU timers, GPU timestamps around the same scopes
+// when timer queries are available, per-frame counters, rolling averages
+// for an on-screen overlay and an optional Chrome trace (chrome://tracing,
+// Perfetto) of every scope.
+//
+// Single threaded: scopes must be opened and closed on the render thread.
+class Profiler {
+public:
+	static Profiler& get();
+
+	// GPU timing needs a current context; without one (or without timer
+	// queries) only CPU times are recorded
+	void initGpu();
+	void shutdownGpu();
+
+	void beginFrame();
+	void endFrame();
+
+	void beginScope(const char* name, bool gpu);
+	void endScope();
+
+	// Allocation counting costs a flag check per allocation while off and a
+	// thread-local increment while on; Game turns it on with the profiler
+	static void setAllocationCounting(bool enabled);
+
+	// Render thread only, like the scopes
+	static void count(ProfileCounter counter, uint64_t amount = 1) { counters[static_cast<int>(counter)] += amount; }
+
+	// Every scope from now on is kept for the trace, written by stopTrace()
+	void startTrace(const std::string& path);
+	void stopTrace();
+
+	// Counter value of the most recently ended frame
+	uint64_t lastFrameCount(ProfileCounter counter) const {
+		return frameNumber == 0 ? 0 : counterHistory[(frameNumber - 1) % historyFrames][static_cast<int>(counter)];
+	}
+
+	// Rolling averages over the last frames, one line per entry
+	void overlayLines(std::vector<std::string>& lines) const;
+
+private:
+	using Clock = std::chrono::steady_clock;
+	static const int historyFrames = 60;
+	static const int gpuLatency = 4; // frames before GPU results are read back
+	static uint64_t counters[static_cast<int>(ProfileCounter::Count)];
+
+	struct ScopeStats {
+		const char* name;
+		double cpuFrame = 0.0, gpuFrame = 0.0; // ms in the current frame
+		std::array<double, historyFrames> cpuHistory = {}, gpuHistory = {};
+		double cpuSum = 0.0, gpuSum = 0.0;
+	};
+	struct OpenScope {
+		int stats;
+		Clock::time_point start;
+		int gpuQuery; // index into the frame's queries, -1 for CPU only
+	};
+	struct GpuQuery {
+		int stats;
+		GLuint begin, end;
+	};
+	struct GpuFrame {
+		std::vector<GpuQuery> queries;
+		size_t used = 0;
+	};
+	struct TraceEvent {
+		const char* name;
+		double start, duration; // microseconds since trace start
+		int thread; // 1 = CPU, 2 = GPU
+	};
+	struct TraceCounters {
+		double time;
+		std::string args; // JSON object with the frame's counters
+	};
+
+	std::vector<ScopeStats> scopes;
+	std::vector<OpenScope> openScopes;
+
+	bool gpuTiming = false;
+	std::array<GpuFrame, gpuLatency> gpuFrames;
+	int gpuFrameIndex = 0;
+	int64_t gpuClockOffset = 0; // GL_TIMESTAMP ns minus CPU ns since trace start
+
+	uint64_t frameNumber = 0;
+	std::array<std::array<uint64_t, static_cast<int>(ProfileCounter::Count)>, historyFrames> counterHistory = {};
+	std::array<double, historyFrames> frameHistory = {};
+	Clock::time_point frameStart;
+	uint64_t allocationsAtFrameStart = 0;
+
+	bool tracing = false;
+	std::string tracePath;
+	Clock::time_point traceStart;
+	std::vector<TraceEvent> traceEvents;
+	std::vector<TraceCounters> traceCounters;
+
+	int findScope(const char* name);
+	void collectGpuFrame(GpuFrame& frame);
+	double sinceTraceStart(Clock::time_point time) const;
+};
+
+// Times the enclosing block: `ProfileScope scope("render", true);`
+class ProfileScope {
+public:
+	explicit ProfileScope(const char* name, bool gpu = false) { Profiler::get().beginScope(name, gpu); }
+	~ProfileScope() { Profiler::get().endScope(); }
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+};
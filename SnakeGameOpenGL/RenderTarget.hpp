@@ -0,0 +1,20 @@
+#pragma once
+#include <glad/glad.h>
+
+// Offscreen framebuffer with an RGBA8 color renderbuffer. Used instead of
+// the window's default framebuffer when running headless.
+class RenderTarget {
+public:
+	RenderTarget(int width, int height);
+	~RenderTarget();
+	RenderTarget(const RenderTarget&) = delete;
+	RenderTarget& operator=(const RenderTarget&) = delete;
+
+	bool isComplete() const { return complete; }
+	void bind() const;
+
+private:
+	GLuint framebuffer = 0, colorBuffer = 0;
+	int width, height;
+	bool complete = false;
+};
@@ -1,11 +1,12 @@
 #include "Renderer.hpp"
-#include <fstream>
-#include <sstream>
+#include "Profiler.hpp"
 #include <iostream>
 #include <glm/gtc/matrix_transform.hpp>
 #include <vector>
+#include <cstddef>
 
-Renderer::Renderer(int screenWidth, int screenHeight):width(screenWidth), height(screenHeight) {
+Renderer::Renderer(int screenWidth, int screenHeight, StreamBuffer& stream):width(screenWidth), height(screenHeight), stream(stream) {
+	// Unit quad shared by every instanced VAO
 	float vertices[] = {
 		0.0f, 0.0f,
 		1.0f, 0.0f,
@@ -16,174 +17,171 @@ Renderer::Renderer(int screenWidth, int screenHeight):width(screenWidth), height
 		0.0f, 1.0f
 	};
 
-
-	glGenVertexArrays(1, &VAO);
 	glGenBuffers(1, &VBO);
-
-	glBindVertexArray(VAO);
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
 	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	//  Position attribute
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
+	// Instanced batch: the unit quad above is shared, each instance supplies
+	// its own rect and color from wherever the stream buffer put it
+	createInstanceVAO(batchVAO, stream.buffer());
 
-	//Load shaders 
-	shaderProgram = loadShader("vertex.glsl", "fragment.glsl");
+	batchShader.load("instanced_vertex.glsl", "instanced_fragment.glsl");
+	batchProjectionLoc = batchShader.uniform("projection");
+	batchOffsetLoc = batchShader.uniform("offset");
+
+	gridLayer = createLayer();
 }
 
 Renderer::~Renderer() {
-	glDeleteVertexArrays(1, &VAO);
 	glDeleteBuffers(1, &VBO);
-	glDeleteProgram(shaderProgram);
+	glDeleteVertexArrays(1, &batchVAO);
+	for (auto& layer : layers) {
+		glDeleteVertexArrays(1, &layer.VAO);
+		glDeleteBuffers(1, &layer.VBO);
+	}
 }
 
+void Renderer::createInstanceVAO(GLuint& vao, GLuint instanceBuffer) {
+	glGenVertexArrays(1, &vao);
 
-void Renderer::drawRectangle(float x, float y, float widthRect, float heightRect, const glm::vec3& color) const {
-    glUseProgram(shaderProgram);
-
-    // Fix for aspect ratio
-    float aspect = static_cast<float>(width) / static_cast<float>(height);
-    glm::mat4 model = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / aspect, 1.0f, 1.0f));
-
-    // Apply translation and non-uniform scaling
-    model = glm::translate(model, glm::vec3(x, y, 0.0f));
-    model = glm::scale(model, glm::vec3(widthRect, heightRect, 1.0f));
-
-    // Send matrix to shader
-    GLuint modelLoc = glGetUniformLocation(shaderProgram, "model");
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, &model[0][0]);
-
-    // Send color
-    GLuint colorLoc = glGetUniformLocation(shaderProgram, "color");
-    glUniform3fv(colorLoc, 1, &color[0]);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
 
-    // Bind and draw
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	setInstanceAttributes(0);
+	glBindVertexArray(0);
 }
 
-
-std::vector<float> generateCircleVertices(float cx, float cy, float radius, int segments) {
-    std::vector<float> vertices;
-
-    // Center of the circle
-    vertices.push_back(cx);
-    vertices.push_back(cy);
-
-    for (int i = 0; i <= segments; ++i) {
-        float theta = 2.0f * 3.1415926f * float(i) / float(segments);
-        float x = cx + radius * cosf(theta);
-        float y = cy + radius * sinf(theta);
-        vertices.push_back(x);
-        vertices.push_back(y);
-    }
-
-    return vertices;
+// Points the instance attributes of the bound VAO at `offset` bytes into the
+// bound array buffer. GL 3.3 has no base instance, so this is how a draw
+// starts at its own slice of the stream buffer.
+void Renderer::setInstanceAttributes(size_t offset) {
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(QuadInstance), (void*)(offset + offsetof(QuadInstance, rect)));
+	glEnableVertexAttribArray(1);
+	glVertexAttribDivisor(1, 1);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(QuadInstance), (void*)(offset + offsetof(QuadInstance, color)));
+	glEnableVertexAttribArray(2);
+	glVertexAttribDivisor(2, 1);
+	glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(QuadInstance), (void*)(offset + offsetof(QuadInstance, roundness)));
+	glEnableVertexAttribArray(3);
+	glVertexAttribDivisor(3, 1);
 }
 
+void Renderer::setViewportSize(int screenWidth, int screenHeight) {
+	width = screenWidth;
+	height = screenHeight;
+}
 
-void Renderer::drawCircle(float cx, float cy, float radius, const glm::vec3& color) const {
-    std::vector<float> vertices = generateCircleVertices(cx, cy, radius, 50);
-
-    GLuint circleVAO, circleVBO;
-    glGenVertexArrays(1, &circleVAO);
-    glGenBuffers(1, &circleVBO);
-
-    glBindVertexArray(circleVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, circleVBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glUseProgram(shaderProgram);
-
-    // Identity model (no transformation, already positioned)
-    float aspect = (float)width / (float)height;
-    glm::mat4 model = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / aspect, 1.0f, 1.0f));
-    
-    model = glm::translate(model, glm::vec3(cx, cy, 0.0f));
-    model = glm::scale(model, glm::vec3(radius, radius, 1.0f));
-
-    GLuint modelLoc = glGetUniformLocation(shaderProgram, "model");
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, &model[0][0]);
+void Renderer::setView(glm::vec2 center, glm::vec2 extent) {
+	viewCenter = center;
+	viewExtent = extent;
+}
 
-    GLuint colorLoc = glGetUniformLocation(shaderProgram, "color");
-    glUniform3fv(colorLoc, 1, &color[0]);
 
-    glDrawArrays(GL_TRIANGLE_FAN, 0, vertices.size() / 2);
+void Renderer::beginBatch() {
+	instances.clear();
+}
 
-    glDeleteVertexArrays(1, &circleVAO);
-    glDeleteBuffers(1, &circleVBO);
+void Renderer::submitQuad(float x, float y, float widthRect, float heightRect, const glm::vec3& color, float roundness) {
+	instances.push_back({ glm::vec4(x, y, widthRect, heightRect), color, roundness });
 }
 
+void Renderer::submitCircle(float cx, float cy, float radius, const glm::vec3& color) {
+	submitQuad(cx - radius, cy - radius, radius * 2.0f, radius * 2.0f, color, 1.0f);
+}
 
-GLuint Renderer::loadShader(const char* vertexPath, const char* fragmentPath) {
-    auto readFile = [](const char* path) -> std::string {
-        std::ifstream file(path);
-        std::stringstream buffer;
-        if (!file.is_open()) {
-            std::cerr << "Failed to open shader file: " << path << std::endl;
-            return "";
-        }
-        buffer << file.rdbuf();
-		std::cout << "Shader file loaded successfully: " << path << std::endl;
-        return buffer.str();
-        };
+void Renderer::flushBatch() {
+	if (instances.empty()) {
+		return;
+	}
 
-    std::string vertexCode = readFile(vertexPath);
-    std::string fragmentCode = readFile(fragmentPath);
+	size_t offset = stream.write(instances.data(), instances.size() * sizeof(QuadInstance));
 
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
+	useBatchShader(glm::vec2(0.0f));
 
-    GLuint vertex, fragment;
-    GLint success;
-    char infoLog[512];
+	glBindVertexArray(batchVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, stream.buffer());
+	setInstanceAttributes(offset);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(instances.size()));
+	Profiler::count(ProfileCounter::DrawCalls);
+	glBindVertexArray(0);
 
-    // Vertex Shader
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, nullptr);
-    glCompileShader(vertex);
+	instances.clear();
+}
 
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertex, 512, nullptr, infoLog);
-        std::cerr << "Vertex Shader Compilation Failed:" << std::endl << infoLog << std::endl;
-    }
+glm::mat4 Renderer::viewProjection() const {
+	// Undo the window's aspect ratio after mapping the view rectangle onto
+	// [-1, 1], so cells stay square
+	float aspect = static_cast<float>(width) / static_cast<float>(height);
+	glm::mat4 projection = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f / aspect, 1.0f, 1.0f));
+	projection = glm::scale(projection, glm::vec3(2.0f / viewExtent.x, 2.0f / viewExtent.y, 1.0f));
+	return glm::translate(projection, glm::vec3(-viewCenter.x, -viewCenter.y, 0.0f));
+}
 
-    // Fragment Shader
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, nullptr);
-    glCompileShader(fragment);
+void Renderer::useBatchShader(glm::vec2 offset) const {
+	batchShader.use();
 
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragment, 512, nullptr, infoLog);
-        std::cerr << "Fragment Shader Compilation Failed:" << std::endl << infoLog <<std::endl;
-    }
+	glm::mat4 projection = viewProjection();
+	glUniformMatrix4fv(batchProjectionLoc, 1, GL_FALSE, &projection[0][0]);
+	glUniform2f(batchOffsetLoc, offset.x, offset.y);
+	Profiler::count(ProfileCounter::UniformUploads, 2);
+}
 
-    // Shader Program
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vertex);
-    glAttachShader(program, fragment);
-    glLinkProgram(program);
+LayerHandle Renderer::createLayer() {
+	InstanceLayer layer;
+	glGenBuffers(1, &layer.VBO);
+	createInstanceVAO(layer.VAO, layer.VBO);
+	layers.push_back(layer);
+	return static_cast<LayerHandle>(layers.size() - 1);
+}
 
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(program, 512, nullptr, infoLog);
-        std::cerr << "Shader Program Linking Failed:"<< std::endl << infoLog << std::endl;
-    }
-    else {
-		std::cout << "Shader Program linked successfully" << std::endl;
-    }
+void Renderer::uploadLayer(LayerHandle handle, const std::vector<QuadInstance>& quads) {
+	InstanceLayer& layer = layers[handle];
+	glBindBuffer(GL_ARRAY_BUFFER, layer.VBO);
+	if (quads.size() > layer.capacity) {
+		layer.capacity = quads.size();
+		glBufferData(GL_ARRAY_BUFFER, quads.size() * sizeof(QuadInstance), quads.data(), GL_STATIC_DRAW);
+	}
+	else if (!quads.empty()) {
+		glBufferSubData(GL_ARRAY_BUFFER, 0, quads.size() * sizeof(QuadInstance), quads.data());
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	Profiler::count(ProfileCounter::BufferUploads);
+	layer.count = static_cast<GLsizei>(quads.size());
+}
 
-    // Cleanup
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+void Renderer::drawLayer(LayerHandle handle, glm::vec2 offset) const {
+	const InstanceLayer& layer = layers[handle];
+	if (layer.count == 0) {
+		return;
+	}
+
+	useBatchShader(offset);
+	glBindVertexArray(layer.VAO);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, layer.count);
+	Profiler::count(ProfileCounter::DrawCalls);
+	glBindVertexArray(0);
+}
 
+void Renderer::bakeGrid(int gridWidth, int gridHeight, const glm::vec3& color) {
+	std::vector<QuadInstance> cells;
+	cells.reserve(static_cast<size_t>(gridWidth) * gridHeight);
+	for (int y = 0; y < gridHeight; ++y) {
+		for (int x = 0; x < gridWidth; ++x) {
+			cells.push_back({ glm::vec4(float(x), float(y), 1.0f, 1.0f), color, 0.0f });
+		}
+	}
+
+	uploadLayer(gridLayer, cells);
+	bakedGridWidth = gridWidth;
+	bakedGridHeight = gridHeight;
+}
 
-    return program;
+void Renderer::drawBakedGrid(glm::vec2 offset) const {
+	drawLayer(gridLayer, offset);
 }
+
@@ -1,21 +1,84 @@
 #pragma once
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include "ShaderProgram.hpp"
+#include "StreamBuffer.hpp"
 #include <string>
+#include <vector>
 
+// Per-instance data for the batched quad path. Layout matches the
+// attributes declared in instanced_vertex.glsl.
+struct QuadInstance {
+	glm::vec4 rect;   // x, y, width, height
+	glm::vec3 color;
+	float roundness;  // corner radius as a fraction of the shorter half side: 0 square, 1 circle/capsule
+};
+
+// Handle to a retained instance buffer created with Renderer::createLayer.
+using LayerHandle = int;
 
 class Renderer {
 public:
-	Renderer(int screenWidth, int screenHeight);
+	// Per-frame batches are written into `stream`; the caller calls its
+	// endFrame() once per frame
+	Renderer(int screenWidth, int screenHeight, StreamBuffer& stream);
 	~Renderer();
 
-	void drawRectangle(float x, float y, float width, float height, const glm::vec3& color) const;
-	void drawCircle(float cx, float cy, float radius, const glm::vec3& color) const;
+	// Batched quads: everything submitted between beginBatch() and flushBatch()
+	// is uploaded into one instance buffer and drawn with a single call.
+	// Rounded corners and circles are cut out of the same unit quad by a
+	// signed distance in the fragment shader, so they batch with the rest.
+	void beginBatch();
+	void submitQuad(float x, float y, float width, float height, const glm::vec3& color, float roundness = 0.0f);
+	void submitCircle(float cx, float cy, float radius, const glm::vec3& color);
+	void flushBatch();
+
+	// Retained instance layers: quads uploaded once and redrawn with a single
+	// instanced call, optionally shifted by a world-space offset.
+	LayerHandle createLayer();
+	void uploadLayer(LayerHandle layer, const std::vector<QuadInstance>& quads);
+	void drawLayer(LayerHandle layer, glm::vec2 offset = glm::vec2(0.0f)) const;
+
+	// Background grid of unit cells baked once into a layer. Only needs
+	// rebaking when the grid dimensions change; window resizes are handled
+	// by the projection.
+	void bakeGrid(int gridWidth, int gridHeight, const glm::vec3& color);
+	void drawBakedGrid(glm::vec2 offset = glm::vec2(0.0f)) const;
+	bool isGridBaked(int gridWidth, int gridHeight) const { return bakedGridWidth == gridWidth && bakedGridHeight == gridHeight; }
+
+	void setViewportSize(int screenWidth, int screenHeight);
+
+	// World-space rectangle mapped onto the [-1, 1] square for batched and
+	// layered quads. The default (center 0, extent 2) keeps NDC coordinates.
+	void setView(glm::vec2 center, glm::vec2 extent);
+	// World to clip space for the current view and viewport
+	glm::mat4 viewProjection() const;
 
 private:
 	int width, height;
 
-	GLuint VAO, VBO, shaderProgram;
+	GLuint VBO; // unit quad
+
+	StreamBuffer& stream;
+	GLuint batchVAO;
+	ShaderProgram batchShader;
+	GLint batchProjectionLoc, batchOffsetLoc;
+	std::vector<QuadInstance> instances;
+
+	glm::vec2 viewCenter = glm::vec2(0.0f);
+	glm::vec2 viewExtent = glm::vec2(2.0f);
+
+	struct InstanceLayer {
+		GLuint VAO = 0, VBO = 0;
+		GLsizei count = 0;
+		size_t capacity = 0;
+	};
+	std::vector<InstanceLayer> layers;
+
+	LayerHandle gridLayer;
+	int bakedGridWidth = 0, bakedGridHeight = 0;
 
-	GLuint loadShader(const char* vertextPath, const char* fragmentPath);
+	void createInstanceVAO(GLuint& vao, GLuint instanceBuffer);
+	void setInstanceAttributes(size_t offset);
+	void useBatchShader(glm::vec2 offset) const;
 };
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "Replay.hpp"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace {
+
+void writeVarint(std::vector<uint8_t>& out, uint64_t value) {
+	while (value >= 0x80) {
+		out.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<uint8_t>(value));
+}
+
+void writeFixed(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+	for (int i = 0; i < bytes; ++i) {
+		out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+	}
+}
+
+struct Reader {
+	const std::vector<uint8_t>& data;
+	size_t position = 0;
+	bool ok = true;
+
+	uint64_t varint() {
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			if (position >= data.size()) {
+				ok = false;
+				return 0;
+			}
+			uint8_t byte = data[position++];
+			value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) {
+				return value;
+			}
+		}
+		ok = false;
+		return 0;
+	}
+
+	uint64_t fixed(int bytes) {
+		if (position + bytes > data.size()) {
+			ok = false;
+			return 0;
+		}
+		uint64_t value = 0;
+		for (int i = 0; i < bytes; ++i) {
+			value |= static_cast<uint64_t>(data[position++]) << (i * 8);
+		}
+		return value;
+	}
+};
+
+} // namespace
+
+bool Replay::save(const std::string& path) const {
+	std::vector<uint8_t> data = { 'S', 'N', 'K', 'R', version };
+	writeVarint(data, gridWidth);
+	writeVarint(data, gridHeight);
+	writeFixed(data, seed, 4);
+	writeVarint(data, tickCount);
+	writeVarint(data, static_cast<uint32_t>(finalScore));
+	data.push_back(static_cast<uint8_t>(finalState));
+	writeFixed(data, finalHash, 8);
+
+	writeVarint(data, events.size());
+	uint32_t previousTick = 0;
+	for (const auto& event : events) {
+		uint64_t delta = event.tick - previousTick;
+		writeVarint(data, (delta << 2) | static_cast<uint64_t>(event.direction));
+		previousTick = event.tick;
+	}
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		std::cerr << "Failed to write replay: " << path << std::endl;
+		return false;
+	}
+	file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	return static_cast<bool>(file);
+}
+
+bool Replay::load(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		std::cerr << "Failed to open replay: " << path << std::endl;
+		return false;
+	}
+	std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	if (data.size() < 5 || data[0] != 'S' || data[1] != 'N' || data[2] != 'K' || data[3] != 'R' || data[4] != version) {
+		std::cerr << "Not a replay file (or unsupported version): " << path << std::endl;
+		return false;
+	}
+
+	Reader reader{ data, 5 };
+	gridWidth = static_cast<uint32_t>(reader.varint());
+	gridHeight = static_cast<uint32_t>(reader.varint());
+	seed = static_cast<uint32_t>(reader.fixed(4));
+	tickCount = static_cast<uint32_t>(reader.varint());
+	finalScore = static_cast<int32_t>(reader.varint());
+	finalState = static_cast<GameState>(reader.fixed(1));
+	finalHash = reader.fixed(8);
+
+	uint64_t eventCount = reader.varint();
+	events.clear();
+	uint32_t tick = 0;
+	for (uint64_t i = 0; i < eventCount && reader.ok; ++i) {
+		uint64_t packed = reader.varint();
+		tick += static_cast<uint32_t>(packed >> 2);
+		events.push_back({ tick, static_cast<Direction>(packed & 3) });
+	}
+
+	if (!reader.ok || gridWidth < 2 || gridHeight < 2 || gridWidth > static_cast<uint32_t>(maxGridSize) || gridHeight > static_cast<uint32_t>(maxGridSize)) {
+		std::cerr << "Corrupt replay file: " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void ReplayRecorder::begin(const Simulation& simulation, uint32_t seed) {
+	replay = Replay();
+	replay.gridWidth = static_cast<uint32_t>(simulation.getGridWidth());
+	replay.gridHeight = static_cast<uint32_t>(simulation.getGridHeight());
+	replay.seed = seed;
+	lastDirection = simulation.getDirection();
+	active = true;
+}
+
+void ReplayRecorder::beforeTick(const Simulation& simulation) {
+	if (!active) {
+		return;
+	}
+	Direction direction = simulation.getDirection();
+	if (direction != lastDirection) {
+		replay.events.push_back({ simulation.getTickCount() + 1, direction });
+		lastDirection = direction;
+	}
+}
+
+void ReplayRecorder::finish(const Simulation& simulation) {
+	if (!active) {
+		return;
+	}
+	replay.tickCount = simulation.getTickCount();
+	replay.finalScore = simulation.getScore();
+	replay.finalState = simulation.getState();
+	replay.finalHash = simulation.stateHash();
+	active = false;
+}
+
+ReplayResult runReplay(const Replay& replay) {
+	auto start = std::chrono::steady_clock::now();
+
+	Simulation simulation(static_cast<int>(replay.gridWidth), static_cast<int>(replay.gridHeight), replay.seed);
+	size_t nextEvent = 0;
+	for (uint32_t tick = 1; tick <= replay.tickCount; ++tick) {
+		while (nextEvent < replay.events.size() && replay.events[nextEvent].tick == tick) {
+			simulation.applyCommand(turnCommand(replay.events[nextEvent].direction));
+			++nextEvent;
+		}
+		simulation.tick();
+	}
+
+	ReplayResult result;
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	result.ticks = simulation.getTickCount();
+	result.score = simulation.getScore();
+	result.matched = result.ticks == replay.tickCount &&
+		result.score == replay.finalScore &&
+		simulation.getState() == replay.finalState &&
+		simulation.stateHash() == replay.finalHash;
+	return result;
+}
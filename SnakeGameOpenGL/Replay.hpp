@@ -0,0 +1,63 @@
+#pragma once
+#include "Simulation.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Direction change applied on a given tick (counted from 1 after reset)
+struct ReplayEvent {
+	uint32_t tick;
+	Direction direction;
+};
+
+// A recorded game: the seed plus every direction change, and the final
+// state to check a re-run against.
+//
+// File layout (little endian, varints are LEB128):
+//   "SNKR" | u8 version | varint gridWidth | varint gridHeight | u32 seed
+//   varint tickCount | varint finalScore | u8 finalState | u64 finalHash
+//   varint eventCount | eventCount x varint((tickDelta << 2) | direction)
+// A turn therefore costs one byte when it comes within 31 ticks of the last.
+struct Replay {
+	static const uint8_t version = 1;
+
+	uint32_t gridWidth = 0, gridHeight = 0;
+	uint32_t seed = 0;
+	uint32_t tickCount = 0;
+	int32_t finalScore = 0;
+	GameState finalState = GameState::Playing;
+	uint64_t finalHash = 0;
+	std::vector<ReplayEvent> events;
+
+	bool save(const std::string& path) const;
+	bool load(const std::string& path);
+};
+
+// Collects a Replay while a game is played. Call begin() right after the
+// simulation was reseeded and reset, beforeTick() before every tick and
+// finish() once the game is over (or abandoned).
+class ReplayRecorder {
+public:
+	void begin(const Simulation& simulation, uint32_t seed);
+	void beforeTick(const Simulation& simulation);
+	void finish(const Simulation& simulation);
+
+	const Replay& getReplay() const { return replay; }
+	bool isActive() const { return active; }
+
+private:
+	Replay replay;
+	Direction lastDirection = Direction::RIGHT;
+	bool active = false;
+};
+
+struct ReplayResult {
+	bool matched = false;
+	int score = 0;
+	uint32_t ticks = 0;
+	double seconds = 0.0;
+};
+
+// Re-runs a recording with no window as fast as possible and compares the
+// final score, state and state hash with what was recorded.
+ReplayResult runReplay(const Replay& replay);
@@ -0,0 +1,206 @@
+#include "ShaderProgram.hpp"
+#include "CacheDirectory.hpp"
+#include "GlExtensions.hpp"
+#include "Hash.hpp"
+#include "Profiler.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+GLuint ShaderProgram::currentProgram = 0;
+
+namespace {
+
+std::string readFile(const char* path) {
+	std::ifstream file(path);
+	std::stringstream buffer;
+	if (!file.is_open()) {
+		std::cerr << "Failed to open shader file: " << path << std::endl;
+		return "";
+	}
+	buffer << file.rdbuf();
+	return buffer.str();
+}
+
+bool binaryCacheSupported() {
+	if (!glExtensions().hasProgramBinary) {
+		return false;
+	}
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	return formats > 0;
+}
+
+GLuint compileStage(GLenum type, const std::string& source, const char* label) {
+	const char* code = source.c_str();
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &code, nullptr);
+	glCompileShader(shader);
+
+	GLint success;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+	if (!success) {
+		char infoLog[512];
+		glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+		std::cerr << label << " Shader Compilation Failed:" << std::endl << infoLog << std::endl;
+	}
+	return shader;
+}
+
+const char binaryMagic[4] = { 'S', 'N', 'K', 'P' };
+
+} // namespace
+
+ShaderProgram::~ShaderProgram() {
+	if (program == currentProgram) {
+		currentProgram = 0;
+	}
+	glDeleteProgram(program);
+}
+
+bool ShaderProgram::load(const char* vertexPath, const char* fragmentPath) {
+	std::string vertexCode = readFile(vertexPath);
+	std::string fragmentCode = readFile(fragmentPath);
+
+	// Binaries are only valid for the driver that produced them, so the
+	// renderer and version strings are part of the key
+	std::string cachePath;
+	if (binaryCacheSupported()) {
+		uint64_t hash = hashSeed;
+		hashBytes(hash, vertexCode.data(), vertexCode.size() + 1);
+		hashBytes(hash, fragmentCode.data(), fragmentCode.size() + 1);
+		for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+			const char* value = reinterpret_cast<const char*>(glGetString(name));
+			if (value) {
+				hashBytes(hash, value, std::strlen(value));
+			}
+		}
+		char fileName[64];
+		std::snprintf(fileName, sizeof(fileName), "shadercache_%016llx.bin", static_cast<unsigned long long>(hash));
+		cachePath = cacheFilePath(fileName);
+
+		if (loadBinary(cachePath)) {
+			std::cout << "Shader Program loaded from cache: " << vertexPath << ", " << fragmentPath << std::endl;
+			resolveUniforms();
+			return true;
+		}
+	}
+
+	if (!compile(vertexCode, fragmentCode)) {
+		return false;
+	}
+	std::cout << "Shader Program linked successfully: " << vertexPath << ", " << fragmentPath << std::endl;
+	if (!cachePath.empty()) {
+		saveBinary(cachePath);
+	}
+	resolveUniforms();
+	return true;
+}
+
+bool ShaderProgram::compile(const std::string& vertexCode, const std::string& fragmentCode) {
+	GLuint vertex = compileStage(GL_VERTEX_SHADER, vertexCode, "Vertex");
+	GLuint fragment = compileStage(GL_FRAGMENT_SHADER, fragmentCode, "Fragment");
+
+	program = glCreateProgram();
+	glAttachShader(program, vertex);
+	glAttachShader(program, fragment);
+	if (binaryCacheSupported()) {
+		glExtensions().programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	glLinkProgram(program);
+
+	glDeleteShader(vertex);
+	glDeleteShader(fragment);
+
+	GLint success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success) {
+		char infoLog[512];
+		glGetProgramInfoLog(program, 512, nullptr, infoLog);
+		std::cerr << "Shader Program Linking Failed:" << std::endl << infoLog << std::endl;
+		glDeleteProgram(program);
+		program = 0;
+		return false;
+	}
+	return true;
+}
+
+// Cache file: "SNKP" | u32 binary format | driver-specific program binary
+bool ShaderProgram::loadBinary(const std::string& cachePath) {
+	std::ifstream file(cachePath, std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+	std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (data.size() <= 8 || std::memcmp(data.data(), binaryMagic, 4) != 0) {
+		return false;
+	}
+	GLenum format;
+	std::memcpy(&format, data.data() + 4, sizeof(format));
+
+	program = glCreateProgram();
+	glExtensions().programBinary(program, format, data.data() + 8, static_cast<GLsizei>(data.size() - 8));
+	GLint success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success) {
+		// Stale (e.g. driver update without a version string change): rebuild
+		glDeleteProgram(program);
+		program = 0;
+		return false;
+	}
+	return true;
+}
+
+void ShaderProgram::saveBinary(const std::string& cachePath) const {
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) {
+		return;
+	}
+	std::vector<char> binary(static_cast<size_t>(length));
+	GLenum format = 0;
+	glExtensions().getProgramBinary(program, length, nullptr, &format, binary.data());
+
+	std::ofstream file(cachePath, std::ios::binary);
+	if (!file.is_open()) {
+		return;
+	}
+	file.write(binaryMagic, 4);
+	file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+	file.write(binary.data(), length);
+}
+
+void ShaderProgram::resolveUniforms() {
+	uniforms.clear();
+	GLint count = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+	for (GLint i = 0; i < count; ++i) {
+		char name[128];
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(program, static_cast<GLuint>(i), sizeof(name), &length, &size, &type, name);
+		uniforms.emplace_back(std::string(name, length), glGetUniformLocation(program, name));
+	}
+}
+
+GLint ShaderProgram::uniform(const char* name) const {
+	for (const auto& entry : uniforms) {
+		if (entry.first == name) {
+			return entry.second;
+		}
+	}
+	return -1;
+}
+
+void ShaderProgram::use() const {
+	if (program == currentProgram) {
+		return;
+	}
+	glUseProgram(program);
+	currentProgram = program;
+	Profiler::count(ProfileCounter::ProgramBinds);
+}
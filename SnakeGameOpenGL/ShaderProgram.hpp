@@ -0,0 +1,36 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Linked GLSL program shared by Renderer and TextRenderer. Uniform locations
+// are resolved once after linking, use() skips the glUseProgram call when the
+// program is already bound, and linked binaries are cached on disk (when the
+// driver supports glGetProgramBinary) so warm starts skip compilation.
+class ShaderProgram {
+public:
+	ShaderProgram() = default;
+	~ShaderProgram();
+	ShaderProgram(const ShaderProgram&) = delete;
+	ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+	bool load(const char* vertexPath, const char* fragmentPath);
+	void use() const;
+
+	// -1 for names the linker did not keep; look these up once and store them
+	GLint uniform(const char* name) const;
+	GLuint id() const { return program; }
+
+private:
+	GLuint program = 0;
+	std::vector<std::pair<std::string, GLint>> uniforms;
+
+	static GLuint currentProgram; // last program bound through use()
+
+	bool loadBinary(const std::string& cachePath);
+	void saveBinary(const std::string& cachePath) const;
+	bool compile(const std::string& vertexCode, const std::string& fragmentCode);
+	void resolveUniforms();
+};
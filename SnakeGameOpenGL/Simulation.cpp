@@ -0,0 +1,123 @@
+#include "Simulation.hpp"
+#include "Hash.hpp"
+#include <algorithm>
+
+Simulation::Simulation(int gridWidth, int gridHeight, uint32_t seed):
+	gridWidth(gridWidth), gridHeight(gridHeight),
+	snake(gridWidth * gridHeight),
+	occupied(static_cast<size_t>(gridWidth) * gridHeight, 0),
+	freeCells(gridWidth * gridHeight),
+	rng(seed) {
+	reset();
+}
+
+void Simulation::reset() {
+	// Start over from an empty board rather than releasing the old body:
+	// released cells would land in the free list in a different order than
+	// in a freshly built Simulation, so food (and replays) would diverge
+	std::fill(occupied.begin(), occupied.end(), 0);
+	freeCells.reset();
+	snake.clear();
+	snakeLength = 1;
+	for (int i = 0; i < snakeLength; ++i) {
+		snake.pushBack(cellIndex(glm::ivec2(gridWidth / 2 - i, gridHeight / 2))); // horizontal right
+		occupy(snake.back());
+	}
+	previousTail = snake.back();
+	score = 0;
+	tickCount = 0;
+	state = GameState::Playing;
+	snakeDirection = Direction::RIGHT;
+	lastMoveDirection = Direction::RIGHT;
+	spawnFood();
+}
+
+void Simulation::applyCommand(Command command) {
+	switch (command) {
+		case Command::None:      break;
+		case Command::TurnUp:    turn(Direction::UP); break;
+		case Command::TurnDown:  turn(Direction::DOWN); break;
+		case Command::TurnLeft:  turn(Direction::LEFT); break;
+		case Command::TurnRight: turn(Direction::RIGHT); break;
+		case Command::Restart:   reset(); break;
+	}
+}
+
+void Simulation::turn(Direction direction) {
+	// Compare against the direction actually moved, otherwise two quick turns
+	// between ticks could fold the snake back onto its own neck
+	if (direction != opposite(lastMoveDirection)) {
+		snakeDirection = direction;
+	}
+}
+
+TickEvent Simulation::tick() {
+	if (state == GameState::GameOver) {
+		return TickEvent::None;
+	}
+
+	++tickCount;
+	Cell headCell = stepCell(snake.front(), snakeDirection, gridWidth, gridHeight);
+	lastMoveDirection = snakeDirection;
+
+	// Check collision with self
+	if (occupied[headCell]) {
+		state = GameState::GameOver;
+		return TickEvent::Died;
+	}
+
+	// Insert new head
+	snake.pushFront(headCell);
+	occupy(headCell);
+
+	// Check if food eaten
+	TickEvent event = TickEvent::None;
+	if (headCell == foodCell) {
+		snakeLength++;
+		score += 5;
+		event = TickEvent::FoodEaten;
+		if (!spawnFood()) {
+			// Snake covers the whole board, nothing left to play for
+			state = GameState::GameOver;
+		}
+	}
+
+	// Trim tail
+	previousTail = snake.back();
+	while (static_cast<int>(snake.size()) > snakeLength) {
+		release(snake.back());
+		snake.popBack();
+	}
+	return event;
+}
+
+void Simulation::occupy(Cell cell) {
+	occupied[cell] = 1;
+	freeCells.occupy(static_cast<int>(cell));
+}
+
+void Simulation::release(Cell cell) {
+	occupied[cell] = 0;
+	freeCells.release(static_cast<int>(cell));
+}
+
+bool Simulation::spawnFood() {
+	if (freeCells.empty()) {
+		return false;
+	}
+	foodCell = static_cast<Cell>(freeCells.sample(rng));
+	return true;
+}
+
+uint64_t Simulation::stateHash() const {
+	uint64_t hash = hashSeed;
+	auto mix = [&hash](uint32_t value) { hashWord(hash, value); };
+
+	mix(static_cast<uint32_t>(snake.size()));
+	snake.forEach(mix);
+	mix(foodCell);
+	mix(static_cast<uint32_t>(snakeDirection));
+	mix(static_cast<uint32_t>(score));
+	mix(static_cast<uint32_t>(state));
+	return hash;
+}
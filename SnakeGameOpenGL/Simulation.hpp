@@ -0,0 +1,120 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <random>
+#include "FreeCellSet.hpp"
+#include "SnakeBody.hpp"
+
+enum class Direction { UP, DOWN, LEFT, RIGHT };
+enum class GameState { Playing, GameOver };
+
+// Largest board side accepted from the command line or from a file, so
+// width * height stays far from overflowing int and boards stay allocatable
+const int maxGridSize = 4096;
+
+// Abstract input for the simulation. Game maps keyboard state onto these,
+// bots and tests can feed them directly.
+enum class Command { None, TurnUp, TurnDown, TurnLeft, TurnRight, Restart };
+
+// What happened during a single tick, so callers can react (log, play
+// sounds, ...) without the simulation knowing about them.
+enum class TickEvent { None, FoodEaten, Died };
+
+// Direction helpers shared by the simulation, the bots and replays
+const Direction directions[] = { Direction::UP, Direction::RIGHT, Direction::DOWN, Direction::LEFT };
+
+inline Direction opposite(Direction direction) {
+	switch (direction) {
+		case Direction::UP:    return Direction::DOWN;
+		case Direction::DOWN:  return Direction::UP;
+		case Direction::LEFT:  return Direction::RIGHT;
+		case Direction::RIGHT: return Direction::LEFT;
+	}
+	return direction;
+}
+
+inline Command turnCommand(Direction direction) {
+	switch (direction) {
+		case Direction::UP:    return Command::TurnUp;
+		case Direction::DOWN:  return Command::TurnDown;
+		case Direction::LEFT:  return Command::TurnLeft;
+		case Direction::RIGHT: return Command::TurnRight;
+	}
+	return Command::None;
+}
+
+// Neighbour of a cell on a gridWidth x gridHeight board with wrapped edges
+inline Cell stepCell(Cell cell, Direction direction, int gridWidth, int gridHeight) {
+	int x = static_cast<int>(cell % gridWidth);
+	int y = static_cast<int>(cell / gridWidth);
+	switch (direction) {
+		case Direction::UP:    y = y + 1 == gridHeight ? 0 : y + 1; break;
+		case Direction::DOWN:  y = y == 0 ? gridHeight - 1 : y - 1; break;
+		case Direction::LEFT:  x = x == 0 ? gridWidth - 1 : x - 1; break;
+		case Direction::RIGHT: x = x + 1 == gridWidth ? 0 : x + 1; break;
+	}
+	return static_cast<Cell>(y * gridWidth + x);
+}
+
+// Board state and snake rules with no dependency on GLFW or OpenGL.
+class Simulation {
+public:
+	// Runs started from the same seed and fed the same commands are identical
+	Simulation(int gridWidth, int gridHeight, uint32_t seed);
+
+	void reset();
+	void reseed(uint32_t seed) { rng.seed(seed); } // takes effect from the next food spawn
+	void applyCommand(Command command);
+	TickEvent tick();
+
+	// FNV-1a over everything that determines future play (body, food,
+	// direction, score, state); equal hashes mean replays stayed in sync
+	uint64_t stateHash() const;
+	uint32_t getTickCount() const { return tickCount; }
+
+	// Body as cell indices, head first; use cellPosition to get coordinates
+	const SnakeBody& getSnake() const { return snake; }
+	glm::ivec2 getFood() const { return cellPosition(foodCell); }
+	// Cell the last body segment occupied before the most recent tick (the
+	// vacated tail, or the tail itself when the snake grew). Together with the
+	// body this gives every segment's previous position for interpolation.
+	glm::ivec2 getPreviousTail() const { return cellPosition(previousTail); }
+	Direction getDirection() const { return snakeDirection; }
+	GameState getState() const { return state; }
+	int getScore() const { return score; }
+	int getGridWidth() const { return gridWidth; }
+	int getGridHeight() const { return gridHeight; }
+
+	bool isOccupied(Cell cell) const { return occupied[cell] != 0; }
+	Cell cellIndex(glm::ivec2 cell) const { return static_cast<Cell>(cell.y * gridWidth + cell.x); }
+	glm::ivec2 cellPosition(Cell cell) const { return glm::ivec2(cell % gridWidth, cell / gridWidth); }
+
+private:
+	friend void writeSnapshot(const Simulation& simulation, double accumulator, std::vector<uint8_t>& out);
+	friend bool restoreSnapshot(Simulation& simulation, const uint8_t* data, size_t size, double* accumulator);
+
+	int gridWidth, gridHeight;
+
+	SnakeBody snake;  // body: [head, ..., tail]
+	Direction snakeDirection = Direction::RIGHT;
+	Direction lastMoveDirection = Direction::RIGHT; // direction of the last tick, guards against reversing
+	Cell foodCell = 0;
+	Cell previousTail = 0;
+
+	// One byte per cell, kept in sync with the body as the head is pushed and
+	// the tail popped, so self-collision is a single lookup
+	std::vector<uint8_t> occupied;
+	FreeCellSet freeCells; // cells the snake does not cover, food is drawn from here
+	std::mt19937 rng;
+
+	int snakeLength = 1; // initial length
+	int score = 0;
+	uint32_t tickCount = 0; // ticks since the last reset
+	GameState state = GameState::Playing;
+
+	void turn(Direction direction);
+	void occupy(Cell cell);
+	void release(Cell cell);
+	bool spawnFood(); // random food position, false when the board is full
+};
@@ -0,0 +1,12 @@
+#include "SnakeBody.hpp"
+#include <cstring>
+
+SnakeBody::SnakeBody(int capacity):
+	cells(capacity, 0) {
+}
+
+void SnakeBody::assign(const Cell* source, size_t length) {
+	std::memcpy(cells.data(), source, length * sizeof(Cell));
+	head = 0;
+	count = length;
+}
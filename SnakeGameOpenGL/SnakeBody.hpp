@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Board cell as a flat index (y * gridWidth + x). 32 bits rather than 16 so
+// boards larger than 256x256 still fit.
+using Cell = uint32_t;
+
+// Fixed-capacity ring buffer holding the snake body, head first. Storage is
+// allocated once for the whole board, so moving and growing never touch the
+// heap and the body is always one or two contiguous runs of memory.
+class SnakeBody {
+public:
+	explicit SnakeBody(int capacity);
+
+	void clear() { head = 0; count = 0; }
+	void pushFront(Cell cell) {
+		head = head == 0 ? capacity() - 1 : head - 1;
+		cells[head] = cell;
+		++count;
+	}
+	void pushBack(Cell cell) {
+		cells[wrap(head + count)] = cell;
+		++count;
+	}
+	void popBack() { --count; }
+
+	Cell front() const { return cells[head]; }
+	Cell back() const { return cells[wrap(head + count - 1)]; }
+	Cell operator[](size_t index) const { return cells[wrap(head + index)]; }
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	size_t capacity() const { return cells.size(); }
+
+	// Replace the body with `length` cells, head first, stored from slot 0
+	void assign(const Cell* source, size_t length);
+
+	// Visit segments head to tail, walking at most two contiguous runs
+	template <typename Visit>
+	void forEach(Visit&& visit) const {
+		size_t firstRun = count < capacity() - head ? count : capacity() - head;
+		for (size_t i = 0; i < firstRun; ++i) {
+			visit(cells[head + i]);
+		}
+		for (size_t i = 0; i < count - firstRun; ++i) {
+			visit(cells[i]);
+		}
+	}
+
+private:
+	std::vector<Cell> cells;
+	size_t head = 0;
+	size_t count = 0;
+
+	size_t wrap(size_t index) const { return index >= capacity() ? index - capacity() : index; }
+};
@@ -0,0 +1,207 @@
+#include "Snapshot.hpp"
+#include "MappedFile.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<std::mt19937>::value, "the RNG state is snapshotted with memcpy");
+static_assert(std::is_trivially_copyable<SnapshotHeader>::value, "the header is snapshotted with memcpy");
+
+namespace {
+
+uint64_t align8(uint64_t offset) {
+	return (offset + 7) & ~uint64_t(7);
+}
+
+// Fills in the offsets for a board and body size and returns the total size
+uint64_t layout(SnapshotHeader& header) {
+	uint64_t cells = static_cast<uint64_t>(header.gridWidth) * header.gridHeight;
+	header.bodyOffset = align8(sizeof(SnapshotHeader));
+	header.occupiedOffset = align8(header.bodyOffset + header.bodyLength * sizeof(Cell));
+	header.freeOffset = align8(header.occupiedOffset + cells);
+	header.slotOffset = align8(header.freeOffset + header.freeCount * sizeof(int));
+	header.rngOffset = align8(header.slotOffset + cells * sizeof(int));
+	return header.rngOffset + sizeof(std::mt19937);
+}
+
+// Checks the arrays against each other before anything is copied into a
+// live Simulation: every cell index in range, the body free of duplicates
+// and matching the occupancy bytes, food off the body while playing, and the
+// free list and slot index being exact inverses covering every unoccupied
+// cell. tick() and FreeCellSet index with these values unchecked. O(cells),
+// so only done for files.
+bool validState(const SnapshotHeader& header, const uint8_t* data, uint64_t cells) {
+	if (header.snakeLength < header.bodyLength || header.snakeLength > cells ||
+		header.freeCount != cells - header.bodyLength) {
+		return false;
+	}
+
+	const Cell* body = reinterpret_cast<const Cell*>(data + header.bodyOffset);
+	const uint8_t* occupied = data + header.occupiedOffset;
+	const int* freeList = reinterpret_cast<const int*>(data + header.freeOffset);
+	const int* slots = reinterpret_cast<const int*>(data + header.slotOffset);
+
+	std::vector<uint8_t> inBody(static_cast<size_t>(cells), 0);
+	for (uint32_t i = 0; i < header.bodyLength; ++i) {
+		if (body[i] >= cells || inBody[body[i]]) {
+			return false;
+		}
+		inBody[body[i]] = 1;
+	}
+	// A game that filled the board ends with the food under the head
+	if (header.state == static_cast<uint32_t>(GameState::Playing) && inBody[header.foodCell]) {
+		return false;
+	}
+
+	for (uint64_t cell = 0; cell < cells; ++cell) {
+		int slot = slots[cell];
+		bool free = slot >= 0;
+		if (occupied[cell] != inBody[cell] || free == (inBody[cell] != 0) ||
+			slot < -1 || slot >= static_cast<int64_t>(header.freeCount)) {
+			return false;
+		}
+		if (free && freeList[slot] != static_cast<int>(cell)) {
+			return false;
+		}
+	}
+	// Each free entry is pointed back at by its own cell's slot, which also
+	// rules out duplicates in the list
+	for (uint32_t i = 0; i < header.freeCount; ++i) {
+		int cell = freeList[i];
+		if (cell < 0 || static_cast<uint64_t>(cell) >= cells || slots[cell] != static_cast<int>(i)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// O(1) checks on the header: format, board size, and the recomputed layout
+// (rather than the stored offsets) so every array lies inside the block
+bool readHeader(const uint8_t* data, size_t size, int gridWidth, int gridHeight, SnapshotHeader& header) {
+	if (size < sizeof(SnapshotHeader)) {
+		return false;
+	}
+	std::memcpy(&header, data, sizeof(header));
+
+	uint64_t cells = static_cast<uint64_t>(gridWidth) * gridHeight;
+	if (std::memcmp(header.magic, "SNKS", 4) != 0 || header.version != snapshotVersion ||
+		header.headerSize != sizeof(SnapshotHeader) || header.rngSize != sizeof(std::mt19937)) {
+		std::cerr << "Snapshot format not supported by this build" << std::endl;
+		return false;
+	}
+	if (header.gridWidth != static_cast<uint32_t>(gridWidth) || header.gridHeight != static_cast<uint32_t>(gridHeight)) {
+		std::cerr << "Snapshot is for a " << header.gridWidth << "x" << header.gridHeight << " board" << std::endl;
+		return false;
+	}
+
+	SnapshotHeader expected = header;
+	if (header.bodyLength == 0 || header.bodyLength > cells || header.freeCount > cells ||
+		header.foodCell >= cells || header.previousTail >= cells ||
+		header.direction > 3 || header.lastMoveDirection > 3 || header.state > 1 ||
+		layout(expected) != header.totalSize || header.totalSize > size ||
+		expected.bodyOffset != header.bodyOffset || expected.occupiedOffset != header.occupiedOffset ||
+		expected.freeOffset != header.freeOffset || expected.slotOffset != header.slotOffset ||
+		expected.rngOffset != header.rngOffset) {
+		std::cerr << "Snapshot is corrupt" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+} // namespace
+
+void writeSnapshot(const Simulation& simulation, double accumulator, std::vector<uint8_t>& out) {
+	SnapshotHeader header = {};
+	std::memcpy(header.magic, "SNKS", 4);
+	header.version = snapshotVersion;
+	header.headerSize = sizeof(SnapshotHeader);
+	header.rngSize = sizeof(std::mt19937);
+	header.gridWidth = static_cast<uint32_t>(simulation.gridWidth);
+	header.gridHeight = static_cast<uint32_t>(simulation.gridHeight);
+	header.bodyLength = static_cast<uint32_t>(simulation.snake.size());
+	header.snakeLength = static_cast<uint32_t>(simulation.snakeLength);
+	header.direction = static_cast<uint32_t>(simulation.snakeDirection);
+	header.lastMoveDirection = static_cast<uint32_t>(simulation.lastMoveDirection);
+	header.foodCell = simulation.foodCell;
+	header.previousTail = simulation.previousTail;
+	header.score = simulation.score;
+	header.tickCount = simulation.tickCount;
+	header.state = static_cast<uint32_t>(simulation.state);
+	header.freeCount = static_cast<uint32_t>(simulation.freeCells.size());
+	header.accumulator = accumulator;
+	header.totalSize = layout(header);
+
+	out.assign(static_cast<size_t>(header.totalSize), 0);
+	uint8_t* base = out.data();
+	std::memcpy(base, &header, sizeof(header));
+
+	// The ring buffer may be split in two runs; the snapshot stores it straight
+	Cell* body = reinterpret_cast<Cell*>(base + header.bodyOffset);
+	simulation.snake.forEach([&body](Cell segment) { *body++ = segment; });
+
+	size_t cells = simulation.occupied.size();
+	std::memcpy(base + header.occupiedOffset, simulation.occupied.data(), cells);
+	std::memcpy(base + header.freeOffset, simulation.freeCells.cellData(), header.freeCount * sizeof(int));
+	std::memcpy(base + header.slotOffset, simulation.freeCells.slotData(), cells * sizeof(int));
+	std::memcpy(base + header.rngOffset, &simulation.rng, sizeof(std::mt19937));
+}
+
+bool restoreSnapshot(Simulation& simulation, const uint8_t* data, size_t size, double* accumulator) {
+	SnapshotHeader header;
+	if (!readHeader(data, size, simulation.gridWidth, simulation.gridHeight, header)) {
+		return false;
+	}
+
+	size_t cells = simulation.occupied.size();
+	simulation.snake.assign(reinterpret_cast<const Cell*>(data + header.bodyOffset), header.bodyLength);
+	std::memcpy(simulation.occupied.data(), data + header.occupiedOffset, cells);
+	simulation.freeCells.assign(reinterpret_cast<const int*>(data + header.freeOffset), static_cast<int>(header.freeCount),
+		reinterpret_cast<const int*>(data + header.slotOffset));
+	std::memcpy(&simulation.rng, data + header.rngOffset, sizeof(std::mt19937));
+
+	simulation.snakeLength = static_cast<int>(header.snakeLength);
+	simulation.snakeDirection = static_cast<Direction>(header.direction);
+	simulation.lastMoveDirection = static_cast<Direction>(header.lastMoveDirection);
+	simulation.foodCell = header.foodCell;
+	simulation.previousTail = header.previousTail;
+	simulation.score = header.score;
+	simulation.tickCount = header.tickCount;
+	simulation.state = static_cast<GameState>(header.state);
+	if (accumulator) {
+		*accumulator = header.accumulator;
+	}
+	return true;
+}
+
+bool saveSnapshot(const std::string& path, const Simulation& simulation, double accumulator) {
+	std::vector<uint8_t> data;
+	writeSnapshot(simulation, accumulator, data);
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		std::cerr << "Failed to write snapshot: " << path << std::endl;
+		return false;
+	}
+	file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	return static_cast<bool>(file);
+}
+
+bool loadSnapshot(const std::string& path, Simulation& simulation, double* accumulator) {
+	MappedFile file;
+	if (!file.open(path)) {
+		std::cerr << "Failed to open snapshot: " << path << std::endl;
+		return false;
+	}
+	SnapshotHeader header;
+	int gridWidth = simulation.getGridWidth();
+	int gridHeight = simulation.getGridHeight();
+	if (!readHeader(file.data(), file.size(), gridWidth, gridHeight, header)) {
+		return false;
+	}
+	if (!validState(header, file.data(), static_cast<uint64_t>(gridWidth) * gridHeight)) {
+		std::cerr << "Snapshot is corrupt" << std::endl;
+		return false;
+	}
+	return restoreSnapshot(simulation, file.data(), file.size(), accumulator);
+}
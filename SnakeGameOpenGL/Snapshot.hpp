@@ -0,0 +1,54 @@
+#pragma once
+#include "Simulation.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Complete mid-game state as one flat block that is restored with a handful
+// of memcpys, no parsing. The header is followed by arrays at 8-byte aligned
+// offsets it records:
+//   body cells (head first) | occupancy bytes | free cell list |
+//   cell -> free slot index | raw std::mt19937 state
+// The RNG is stored as its in-memory representation, so a snapshot is only
+// valid for builds with the same standard library; replays are the portable
+// format. headerSize and rngSize catch a mismatch.
+struct SnapshotHeader {
+	char magic[4]; // "SNKS"
+	uint32_t version;
+	uint32_t headerSize;
+	uint32_t rngSize;
+
+	uint32_t gridWidth, gridHeight;
+	uint32_t bodyLength;
+	uint32_t snakeLength;
+	uint32_t direction, lastMoveDirection;
+	uint32_t foodCell, previousTail;
+	int32_t score;
+	uint32_t tickCount;
+	uint32_t state;
+	uint32_t freeCount;
+
+	double accumulator; // caller's fixed-step timer, e.g. Game::moveTimer
+
+	uint64_t bodyOffset, occupiedOffset, freeOffset, slotOffset, rngOffset;
+	uint64_t totalSize;
+};
+
+const uint32_t snapshotVersion = 1;
+
+// Serialise into `out`, which is resized; reusing the same vector keeps
+// repeated checkpoints allocation free.
+void writeSnapshot(const Simulation& simulation, double accumulator, std::vector<uint8_t>& out);
+
+// Overwrite `simulation` with a snapshot from writeSnapshot, for forking in
+// memory. The simulation must have the same grid size. Only the header is
+// checked (format, board size, array bounds), so this stays a few memcpys;
+// returns false and leaves the simulation untouched when that fails.
+// `accumulator` may be null.
+bool restoreSnapshot(Simulation& simulation, const uint8_t* data, size_t size, double* accumulator);
+
+bool saveSnapshot(const std::string& path, const Simulation& simulation, double accumulator);
+// Restores straight from a memory mapping of the file. Files are not
+// trusted, so the arrays are also cross-checked before anything is copied.
+bool loadSnapshot(const std::string& path, Simulation& simulation, double* accumulator);
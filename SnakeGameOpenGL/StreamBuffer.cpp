@@ -0,0 +1,117 @@
+#include "StreamBuffer.hpp"
+#include "GlExtensions.hpp"
+#include "Profiler.hpp"
+#include <cstring>
+#include <iostream>
+
+StreamBuffer::StreamBuffer(size_t regionSize):
+	persistent(glExtensions().hasBufferStorage),
+	regionSize(regionSize) {
+	allocate();
+	std::cout << "Stream buffer: " << (persistent ? "persistent mapped, 3 regions" : "orphaning") << std::endl;
+}
+
+StreamBuffer::~StreamBuffer() {
+	release();
+}
+
+void StreamBuffer::allocate() {
+	glGenBuffers(1, &vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	if (persistent) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLsizeiptr size = static_cast<GLsizeiptr>(regionSize * regionCount);
+		glExtensions().bufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+		mapped = static_cast<uint8_t*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+	}
+	else {
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(regionSize * regionCount), nullptr, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	region = 0;
+	cursor = 0;
+}
+
+void StreamBuffer::release() {
+	for (auto& fence : fences) {
+		if (fence) {
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+	if (mapped) {
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		mapped = nullptr;
+	}
+	glDeleteBuffers(1, &vbo);
+	vbo = 0;
+}
+
+size_t StreamBuffer::write(const void* data, size_t bytes) {
+	size_t start = (cursor + alignment - 1) & ~(alignment - 1);
+	Profiler::count(ProfileCounter::BufferUploads);
+
+	if (persistent) {
+		if (start + bytes > regionSize) {
+			// This frame outgrew its region: size regions for what the frame
+			// has written so far plus headroom, so the buffer is replaced
+			// once rather than every frame. Draws already issued this frame
+			// keep reading the old storage, which the driver holds on to
+			// until the GPU is done with it; the rest of the frame goes into
+			// the new buffer from its start.
+			while (regionSize < (start + bytes) * 2) {
+				regionSize *= 2;
+			}
+			release();
+			allocate();
+			start = 0;
+		}
+		size_t offset = region * regionSize + start;
+		std::memcpy(mapped + offset, data, bytes);
+		cursor = start + bytes;
+		return offset;
+	}
+
+	size_t capacity = regionSize * regionCount;
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	if (start + bytes > capacity) {
+		// Orphan: the driver hands over fresh storage and retires the old
+		// one once pending draws are done
+		while (capacity < bytes) {
+			regionSize *= 2;
+			capacity = regionSize * regionCount;
+		}
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, GL_STREAM_DRAW);
+		start = 0;
+	}
+	// Nothing pending reads this range since the last orphan, so no sync
+	void* target = glMapBufferRange(GL_ARRAY_BUFFER, static_cast<GLintptr>(start), static_cast<GLsizeiptr>(bytes),
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	std::memcpy(target, data, bytes);
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	cursor = start + bytes;
+	return start;
+}
+
+void StreamBuffer::endFrame() {
+	if (!persistent) {
+		return; // the orphaning path just keeps appending
+	}
+
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	region = (region + 1) % regionCount;
+	cursor = 0;
+
+	// The region about to be reused was last drawn from three frames ago;
+	// normally its fence has long signalled
+	GLsync& fence = fences[region];
+	if (fence) {
+		while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {
+		}
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+}
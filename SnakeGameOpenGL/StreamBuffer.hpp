@@ -0,0 +1,44 @@
+#pragma once
+#include <glad/glad.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Ring of per-frame vertex data shared by Renderer and TextRenderer. Each
+// write() copies into the current frame's region and returns the byte
+// offset to point vertex attributes at; endFrame() moves on to the next
+// region.
+//
+// With ARB_buffer_storage (GL 4.4) the buffer is mapped once, persistently
+// and coherently, and split into three regions guarded by fences, so writes
+// never wait on the GPU unless it is three frames behind. On plain GL 3.3
+// writes go through unsynchronized glMapBufferRange into fresh space and the
+// buffer is orphaned when it fills up.
+class StreamBuffer {
+public:
+	explicit StreamBuffer(size_t regionSize = 256 * 1024);
+	~StreamBuffer();
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	size_t write(const void* data, size_t bytes);
+	GLuint buffer() const { return vbo; }
+	void endFrame();
+
+	bool isPersistent() const { return persistent; }
+
+private:
+	static const int regionCount = 3;
+	static const size_t alignment = 16;
+
+	bool persistent;
+	GLuint vbo = 0;
+	uint8_t* mapped = nullptr;
+	size_t regionSize;
+	int region = 0;
+	size_t cursor = 0; // next free byte in the current region (persistent) or buffer (orphaning)
+	std::array<GLsync, regionCount> fences{};
+
+	void allocate();
+	void release();
+};
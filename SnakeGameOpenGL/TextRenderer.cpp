@@ -1,98 +1,106 @@
 #include "TextRenderer.hpp"
+#include "Profiler.hpp"
 #include <iostream>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <fstream>
-#include <sstream>
-
-bool TextRenderer::init(const char* fontPath, int fontSize) {
-    // Init FreeType
-    FT_Library ft;
-    if (FT_Init_FreeType(&ft)) {
-        std::cerr << "ERROR: Could not init FreeType Library" << std::endl;
-        return false;
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+void TextRenderer::preload(const char* fontPath, int fontSize) {
+    pendingPath = fontPath;
+    pendingSize = fontSize;
+    pendingAtlas = std::async(std::launch::async, loadFontAtlas, pendingPath, fontSize);
+}
+
+bool TextRenderer::init(const char* fontPath, int fontSize, StreamBuffer& streamBuffer) {
+    stream = &streamBuffer;
+
+    std::unique_ptr<FontAtlas> atlas;
+    if (pendingAtlas.valid() && pendingPath == fontPath && pendingSize == fontSize) {
+        atlas = pendingAtlas.get();
     }
     else {
-		std::cout << "FreeType initialized successfully" << std::endl;
+        atlas = loadFontAtlas(fontPath, fontSize);
     }
-
-    FT_Face face;
-    if (FT_New_Face(ft, fontPath, 0, &face)) {
-        std::cerr << "ERROR: Failed to load font" << std::endl;
+    if (!atlas) {
         return false;
-	}
-	else {
-		std::cout << "Font loaded successfully: " << fontPath << std::endl;
-	}
-    
-    FT_Set_Pixel_Sizes(face, 0, fontSize);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-    for (unsigned char c = 0; c < 128; c++) {
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
-            std::cerr << "ERROR::FREETYPE: Failed to load Glyph" << std::endl;
-            continue;
-        }
+    }
 
-        GLuint texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-        );
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        Character character = {
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            static_cast<GLuint>(face->glyph->advance.x)
+    for (int c = 0; c < 128; c++) {
+        const GlyphMetrics& glyph = atlas->glyphs[c];
+        characters[c] = {
+            glm::vec2(glyph.x / float(atlas->width), glyph.y / float(atlas->height)),
+            glm::vec2((glyph.x + glyph.width) / float(atlas->width), (glyph.y + glyph.height) / float(atlas->height)),
+            glm::ivec2(glyph.width, glyph.height),
+            glm::ivec2(glyph.bearingX, glyph.bearingY),
+            static_cast<GLuint>(glyph.advance)
         };
-        characters.insert(std::pair<char, Character>(c, character));
     }
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
 
-    // Shader loading (simple)
-    std::string vertCode = loadShaderSource("text_vertex.glsl");
-    std::string fragCode = loadShaderSource("text_fragment.glsl");
-    shaderProgram = createShaderProgram(vertCode.c_str(), fragCode.c_str());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glGenTextures(1, &atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, atlas->width, atlas->height, 0, GL_RED, GL_UNSIGNED_BYTE, atlas->pixels);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    shader.load("text_vertex.glsl", "text_fragment.glsl");
+    projectionLoc = shader.uniform("projection");
+
+    // The projection never changes, so it is uploaded once here rather than per draw
+    shader.use();
+    glm::mat4 projection = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f);
+    glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
 
     glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, nullptr, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+
+    return true;
+}
+
+void TextRenderer::createTextVAO(GLuint& vao, GLuint& vbo) {
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    setTextAttributes(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
+}
 
-    return true;
+// Vertex layout for the bound VAO, starting `offset` bytes into the bound
+// array buffer
+void TextRenderer::setTextAttributes(size_t offset) {
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)(offset + offsetof(TextVertex, vertex)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)(offset + offsetof(TextVertex, color)));
 }
 
 void TextRenderer::drawText(const std::string& text, float x, float y, float scale, glm::vec3 color) {
-    glUseProgram(shaderProgram);
-    glUniform3f(glGetUniformLocation(shaderProgram, "textColor"), color.x, color.y, color.z);
-    glm::mat4 projection = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f);
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(VAO);
+    beginText();
+    queueText(text, x, y, scale, color);
+    flushText();
+}
+
+void TextRenderer::beginText() {
+    vertices.clear();
+}
+
+void TextRenderer::queueText(const std::string& text, float x, float y, float scale, glm::vec3 color) {
+    appendText(vertices, text, x, y, scale, color);
+}
 
+void TextRenderer::appendText(std::vector<TextVertex>& out, const std::string& text, float x, float y, float scale, glm::vec3 color) const {
     for (auto c : text) {
-        Character ch = characters[c];
+        unsigned char code = static_cast<unsigned char>(c);
+        if (code >= characters.size()) {
+            continue;
+        }
+        const Character& ch = characters[code];
 
         float xpos = x + ch.bearing.x * scale;
         float ypos = y - (ch.size.y - ch.bearing.y) * scale;
@@ -100,69 +108,110 @@ void TextRenderer::drawText(const std::string& text, float x, float y, float sca
         float w = ch.size.x * scale;
         float h = ch.size.y * scale;
 
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos,     ypos,       0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
+        float u0 = ch.uvMin.x, v0 = ch.uvMin.y;
+        float u1 = ch.uvMax.x, v1 = ch.uvMax.y;
 
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 0.0f }
-        };
+        out.push_back({ glm::vec4(xpos,     ypos + h, u0, v0), color });
+        out.push_back({ glm::vec4(xpos,     ypos,     u0, v1), color });
+        out.push_back({ glm::vec4(xpos + w, ypos,     u1, v1), color });
 
-        glBindTexture(GL_TEXTURE_2D, ch.textureID);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        out.push_back({ glm::vec4(xpos,     ypos + h, u0, v0), color });
+        out.push_back({ glm::vec4(xpos + w, ypos,     u1, v1), color });
+        out.push_back({ glm::vec4(xpos + w, ypos + h, u1, v0), color });
 
-        glDrawArrays(GL_TRIANGLES, 0, 6);
         x += (ch.advance >> 6) * scale;
     }
+}
+
+void TextRenderer::flushText() {
+    if (vertices.empty()) {
+        return;
+    }
+
+    size_t offset = stream->write(vertices.data(), vertices.size() * sizeof(TextVertex));
+
+    bindTextState();
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, stream->buffer());
+    setTextAttributes(offset);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices.size()));
+    Profiler::count(ProfileCounter::DrawCalls);
 
     glBindVertexArray(0);
     glBindTexture(GL_TEXTURE_2D, 0);
+    vertices.clear();
 }
 
-void TextRenderer::clearText() {
-	for (auto& pair : characters) {
-		glDeleteTextures(1, &pair.second.textureID);
-	}
-	characters.clear();
-	glDeleteVertexArrays(1, &VAO);
-	glDeleteBuffers(1, &VBO);
-	glDeleteProgram(shaderProgram);
-	std::cout << "TextRenderer cleared" << std::endl;
+void TextRenderer::bindTextState() {
+    shader.use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
 }
 
-
-std::string TextRenderer::loadShaderSource(const char* path) {
-    std::ifstream file(path);
-    std::stringstream buffer;
-    if (!file.is_open()) {
-        std::cerr << "Failed to load shader: " << path << std::endl;
-        return "";
-    }
-    buffer << file.rdbuf();
-	std::cout << "Shader loaded successfully: " << path << std::endl;
-    return buffer.str();
+TextHandle TextRenderer::createText() {
+    RetainedText retained;
+    createTextVAO(retained.VAO, retained.VBO);
+    retainedTexts.push_back(retained);
+    return static_cast<TextHandle>(retainedTexts.size() - 1);
 }
 
-GLuint TextRenderer::createShaderProgram(const char* vert, const char* frag) {
-    GLuint vs = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vs, 1, &vert, nullptr);
-    glCompileShader(vs);
+void TextRenderer::setText(TextHandle handle, const std::string& text, float x, float y, float scale, glm::vec3 color) {
+    RetainedText& retained = retainedTexts[handle];
+    if (retained.text == text && retained.x == x && retained.y == y &&
+        retained.scale == scale && retained.color == color) {
+        return;
+    }
 
-    GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fs, 1, &frag, nullptr);
-    glCompileShader(fs);
+    retained.text = text;
+    retained.x = x;
+    retained.y = y;
+    retained.scale = scale;
+    retained.color = color;
+
+    // Build into a reused scratch buffer, then keep the result on the GPU
+    std::vector<TextVertex>& built = retainedScratch;
+    built.clear();
+    appendText(built, text, x, y, scale, color);
+
+    glBindBuffer(GL_ARRAY_BUFFER, retained.VBO);
+    if (built.size() > retained.vertexCapacity) {
+        retained.vertexCapacity = built.size();
+        glBufferData(GL_ARRAY_BUFFER, built.size() * sizeof(TextVertex), built.data(), GL_STATIC_DRAW);
+    }
+    else {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, built.size() * sizeof(TextVertex), built.data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    Profiler::count(ProfileCounter::BufferUploads);
+    retained.vertexCount = static_cast<GLsizei>(built.size());
+}
 
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    glLinkProgram(program);
+void TextRenderer::drawText(TextHandle handle) {
+    const RetainedText& retained = retainedTexts[handle];
+    if (retained.vertexCount == 0) {
+        return;
+    }
 
-    glDeleteShader(vs);
-    glDeleteShader(fs);
+    bindTextState();
+    glBindVertexArray(retained.VAO);
+    glDrawArrays(GL_TRIANGLES, 0, retained.vertexCount);
+    Profiler::count(ProfileCounter::DrawCalls);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
 
-    return program;
+void TextRenderer::clearText() {
+	glDeleteTextures(1, &atlasTexture);
+	atlasTexture = 0;
+	characters = {};
+	for (auto& retained : retainedTexts) {
+		glDeleteVertexArrays(1, &retained.VAO);
+		glDeleteBuffers(1, &retained.VBO);
+	}
+	retainedTexts.clear();
+	glDeleteVertexArrays(1, &VAO);
+	std::cout << "TextRenderer cleared" << std::endl;
 }
+
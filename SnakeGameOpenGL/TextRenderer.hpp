@@ -1,28 +1,86 @@
 #pragma once
 
-#include <map>
+#include <array>
+#include <vector>
+#include <future>
+#include <memory>
 #include <glm/glm.hpp>
-#include <ft2build.h>
-#include FT_FREETYPE_H
 #include <string>
 #include <glad/glad.h>
+#include "ShaderProgram.hpp"
+#include "FontAtlas.hpp"
+#include "StreamBuffer.hpp"
 
 struct Character {
-    GLuint textureID;
+    glm::vec2 uvMin;   // top-left of the glyph in the atlas
+    glm::vec2 uvMax;   // bottom-right of the glyph in the atlas
     glm::ivec2 size;
     glm::ivec2 bearing;
     GLuint advance;
 };
 
+// Interleaved vertex for batched text: position, atlas UV and color, matching
+// text_vertex.glsl.
+struct TextVertex {
+    glm::vec4 vertex; // <vec2 pos, vec2 tex>
+    glm::vec3 color;
+};
+
+// Handle to a string whose geometry stays on the GPU between frames.
+using TextHandle = int;
+
 class TextRenderer {
 public:
-    std::map<char, Character> characters;
-    GLuint VAO, VBO;
-    GLuint shaderProgram;
+    // All glyphs live in one atlas texture, indexed directly by ASCII code
+    std::array<Character, 128> characters{};
+    GLuint atlasTexture = 0;
+    GLuint VAO; // batched text, sourced from the stream buffer
+    ShaderProgram shader;
 
-    bool init(const char* fontPath, int fontSize);
+    // Starts loading the glyphs on a worker thread (from the atlas cache, or
+    // rasterized with FreeType) so it overlaps window and GL setup. init()
+    // with the same font picks the result up; without preload it loads inline.
+    void preload(const char* fontPath, int fontSize);
+    // Batched text is written into `stream`, which must outlive this renderer
+    bool init(const char* fontPath, int fontSize, StreamBuffer& stream);
     void drawText(const std::string& text, float x, float y, float scale, glm::vec3 color);
+
+    // Batched text: every string queued between beginText() and flushText()
+    // is built into one vertex buffer and drawn with a single call.
+    void beginText();
+    void queueText(const std::string& text, float x, float y, float scale, glm::vec3 color);
+    void flushText();
+
+    // Retained text: geometry is rebuilt and uploaded only when setText is
+    // given something different from what the handle already holds.
+    TextHandle createText();
+    void setText(TextHandle handle, const std::string& text, float x, float y, float scale, glm::vec3 color);
+    void drawText(TextHandle handle);
+
     void clearText();
-    GLuint createShaderProgram(const char* vert, const char* frag);
-	std::string loadShaderSource(const char* path);
+
+private:
+    struct RetainedText {
+        std::string text;
+        float x = 0.0f, y = 0.0f, scale = 0.0f;
+        glm::vec3 color = glm::vec3(0.0f);
+        GLuint VAO = 0, VBO = 0;
+        GLsizei vertexCount = 0;
+        size_t vertexCapacity = 0;
+    };
+    std::vector<RetainedText> retainedTexts;
+    std::vector<TextVertex> retainedScratch;
+
+    void createTextVAO(GLuint& vao, GLuint& vbo);
+    void setTextAttributes(size_t offset);
+    void appendText(std::vector<TextVertex>& out, const std::string& text, float x, float y, float scale, glm::vec3 color) const;
+    void bindTextState();
+
+    std::vector<TextVertex> vertices;
+    StreamBuffer* stream = nullptr;
+    GLint projectionLoc = -1;
+
+    std::future<std::unique_ptr<FontAtlas>> pendingAtlas;
+    std::string pendingPath;
+    int pendingSize = 0;
 };
@@ -0,0 +1,108 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threadCount) {
+	threadCount = std::max(1, threadCount);
+	for (int i = 0; i < threadCount; ++i) {
+		queues.push_back(std::make_unique<WorkQueue>());
+	}
+	for (int i = 0; i < threadCount - 1; ++i) {
+		threads.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& task, int grain) {
+	if (count <= 0) {
+		return;
+	}
+	grain = std::max(1, grain);
+
+	// Publish the job before any range becomes visible; the queue mutexes
+	// order this write before a worker can pop work that uses it
+	job = &task;
+
+	int rangeCount = 0;
+	int participant = 0;
+	for (int begin = 0; begin < count; begin += grain) {
+		WorkQueue& queue = *queues[participant];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.ranges.push_back({ begin, std::min(count, begin + grain) });
+		}
+		participant = (participant + 1) % size();
+		++rangeCount;
+	}
+	pendingRanges.fetch_add(rangeCount);
+
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		++generation;
+	}
+	wake.notify_all();
+
+	runRanges(size() - 1);
+	while (pendingRanges.load() > 0) {
+		runRanges(size() - 1);
+		std::this_thread::yield();
+	}
+	job = nullptr;
+}
+
+void ThreadPool::workerLoop(int index) {
+	unsigned long long seen = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(wakeMutex);
+			wake.wait(lock, [&]() { return stopping || generation != seen; });
+			if (stopping) {
+				return;
+			}
+			seen = generation;
+		}
+		runRanges(index);
+	}
+}
+
+void ThreadPool::runRanges(int index) {
+	Range range;
+	while (popOrSteal(index, range)) {
+		for (int i = range.begin; i < range.end; ++i) {
+			(*job)(i);
+		}
+		pendingRanges.fetch_sub(1);
+	}
+}
+
+bool ThreadPool::popOrSteal(int index, Range& out) {
+	{
+		WorkQueue& own = *queues[index];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.ranges.empty()) {
+			out = own.ranges.back();
+			own.ranges.pop_back();
+			return true;
+		}
+	}
+
+	for (int offset = 1; offset < size(); ++offset) {
+		WorkQueue& victim = *queues[(index + offset) % size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.ranges.empty()) {
+			out = victim.ranges.front();
+			victim.ranges.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads with one task deque each. A parallelFor spreads
+// its ranges over the deques; every worker drains its own deque from the back
+// and, once empty, steals from the front of the others. The calling thread
+// takes part as well, so a pool of N runs on N-1 extra threads.
+class ThreadPool {
+public:
+	explicit ThreadPool(int threadCount = static_cast<int>(std::thread::hardware_concurrency()));
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Calls task(i) for every i in [0, count), `grain` indices per stolen unit,
+	// and returns once all of them have finished.
+	void parallelFor(int count, const std::function<void(int)>& task, int grain = 1);
+
+	int size() const { return static_cast<int>(queues.size()); }
+
+private:
+	struct Range {
+		int begin, end;
+	};
+	struct WorkQueue {
+		std::mutex mutex;
+		std::deque<Range> ranges;
+	};
+
+	std::vector<std::thread> threads;
+	std::vector<std::unique_ptr<WorkQueue>> queues; // last one belongs to the caller
+
+	std::mutex wakeMutex;
+	std::condition_variable wake;
+	unsigned long long generation = 0;
+	bool stopping = false;
+
+	const std::function<void(int)>* job = nullptr;
+	std::atomic<int> pendingRanges{ 0 };
+
+	void workerLoop(int index);
+	void runRanges(int index);
+	bool popOrSteal(int index, Range& out);
+};
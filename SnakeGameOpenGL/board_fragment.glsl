@@ -0,0 +1,29 @@
+#version 330 core
+
+in vec2 vWorld;
+out vec4 FragColor;
+
+uniform sampler2D board;  // R8 cell states: 0 empty, 1 body, 2 food
+uniform ivec2 gridSize;
+uniform vec3 emptyColor;
+uniform vec3 bodyColor;
+uniform vec3 foodColor;
+
+void main() {
+    vec2 cell = floor(vWorld);
+    int state = int(texelFetch(board, ivec2(mod(cell, vec2(gridSize))), 0).r * 255.0 + 0.5);
+
+    // Food is the same circle as Renderer::submitCircle, radius 0.4. The
+    // distance is computed outside the branch so fwidth stays defined.
+    float d = length(vWorld - cell - 0.5) - 0.4;
+    float food = clamp(0.5 - d / max(fwidth(d), 1e-5), 0.0, 1.0);
+
+    vec3 color = emptyColor;
+    if (state == 1) {
+        color = bodyColor;
+    }
+    else if (state == 2) {
+        color = mix(emptyColor, foodColor, food);
+    }
+    FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,13 @@
+#version 330 core
+
+uniform mat4 projection;
+uniform vec4 rect;  // x, y, width, height in cells
+
+out vec2 vWorld;    // position in cells, past the board edges for wrapped copies
+
+void main() {
+    // Triangle strip over the rect corners, no vertex buffer needed
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vWorld = rect.xy + corner * rect.zw;
+    gl_Position = projection * vec4(vWorld, 0.0, 1.0);
+}
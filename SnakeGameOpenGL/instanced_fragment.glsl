@@ -0,0 +1,20 @@
+#version 330 core
+
+in vec3 vColor;
+in vec2 vLocal;
+flat in vec2 vHalfSize;
+flat in float vRadius;
+out vec4 FragColor;
+
+void main() {
+    float alpha = 1.0;
+    if (vRadius > 0.0) {
+        // Signed distance to a rounded rectangle; a circle when the radius
+        // is the full half size
+        vec2 q = abs(vLocal) - (vHalfSize - vRadius);
+        float d = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - vRadius;
+        // About one pixel of antialiasing at any zoom
+        alpha = clamp(0.5 - d / max(fwidth(d), 1e-5), 0.0, 1.0);
+    }
+    FragColor = vec4(vColor, alpha);
+}
@@ -0,0 +1,23 @@
+#version 330 core
+
+layout(location = 0) in vec2 aPos;
+layout(location = 1) in vec4 aRect;  // x, y, width, height
+layout(location = 2) in vec3 aColor;
+layout(location = 3) in float aRoundness;
+
+uniform mat4 projection;
+uniform vec2 offset;  // world-space shift for retained layers
+
+out vec3 vColor;
+out vec2 vLocal;            // position relative to the quad center
+flat out vec2 vHalfSize;
+flat out float vRadius;     // corner radius, 0 for a plain quad
+
+void main() {
+    vec2 pos = aRect.xy + offset + aPos * aRect.zw;
+    gl_Position = projection * vec4(pos, 0.0, 1.0);
+    vColor = aColor;
+    vHalfSize = aRect.zw * 0.5;
+    vLocal = (aPos - 0.5) * aRect.zw;
+    vRadius = aRoundness * min(vHalfSize.x, vHalfSize.y);
+}
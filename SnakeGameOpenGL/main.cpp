@@ -1,7 +1,134 @@
 #include "Game.hpp"
+#include "Benchmark.hpp"
+#include "BatchRunner.hpp"
+#include "Arena.hpp"
+#include "Replay.hpp"
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <iomanip>
+#include <vector>
 
-int main() {
-	Game game(1280, 720, "Snake Game");
+// Headless replay: re-run a recording `repeat` times at full speed and check
+// it against the recorded final state
+static int runReplayFile(const char* path, int repeat) {
+	Replay replay;
+	if (!replay.load(path)) {
+		return 1;
+	}
+
+	ReplayResult result;
+	double seconds = 0.0;
+	for (int i = 0; i < repeat; ++i) {
+		result = runReplay(replay);
+		seconds += result.seconds;
+	}
+
+	std::cout << "Replay " << path << ": " << replay.gridWidth << "x" << replay.gridHeight
+		<< ", " << result.ticks << " ticks, " << replay.events.size() << " turns, score " << result.score
+		<< (result.matched ? " (matches recording)" : " (MISMATCH, recorded score " + std::to_string(replay.finalScore) + ")")
+		<< std::endl;
+	if (seconds > 0.0) {
+		std::cout << static_cast<long long>(static_cast<double>(result.ticks) * repeat / seconds) << " ticks/sec" << std::endl;
+	}
+	return result.matched ? 0 : 1;
+}
+
+// Offscreen render benchmark over the standard board sizes; needs no window
+// or GPU, only an EGL or OSMesa capable Mesa
+static int runRenderBenchmark(int frames) {
+	const int sizes[] = { 20, 64, 256 };
+	std::vector<RenderBenchResult> results;
+	for (int size : sizes) {
+		for (int texture = 0; texture < 2; ++texture) {
+			GameConfig config;
+			config.gridWidth = size;
+			config.gridHeight = size;
+			config.headless = true;
+			config.boardTexture = texture != 0;
+			Game game(1280, 720, "Snake Game", config);
+			results.push_back(game.runOffscreen(frames));
+		}
+	}
+
+	std::cout << "Offscreen rendering, 1280x720, " << frames << " frames per board" << std::endl;
+	std::cout << std::setw(10) << "board" << std::setw(9) << "mode" << std::setw(12) << "frames/sec" << std::setw(14) << "draws/frame" << std::setw(16) << "uploads/frame" << std::endl;
+	for (size_t i = 0; i < results.size(); ++i) {
+		int size = sizes[i / 2];
+		std::cout << std::setw(6) << size << "x" << std::setw(3) << size
+			<< std::setw(9) << (i % 2 ? "texture" : "chunks")
+			<< std::setw(12) << std::fixed << std::setprecision(1) << results[i].framesPerSecond()
+			<< std::setw(14) << std::setprecision(2) << results[i].drawCallsPerFrame
+			<< std::setw(16) << results[i].uploadsPerFrame << std::endl;
+	}
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	GameConfig config;
+
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--bench") == 0) {
+			runCollisionBenchmark();
+			runHeadStepBenchmark();
+			runSnapshotBenchmark();
+			runReplayCheck();
+			runAutopilotBenchmark();
+			return 0;
+		}
+		else if (std::strcmp(argv[i], "--batch") == 0 && i + 2 < argc) {
+			int games = std::max(1, std::atoi(argv[i + 1]));
+			int ticks = std::max(1, std::atoi(argv[i + 2]));
+			runBatchBenchmark(games, ticks);
+			return 0;
+		}
+		else if (std::strcmp(argv[i], "--arena") == 0) {
+			// --arena [SNAKES [GRID_SIZE [TICKS]]]
+			int snakes = i + 1 < argc ? std::max(1, std::atoi(argv[i + 1])) : 4000;
+			int size = i + 2 < argc ? std::min(maxGridSize, std::max(8, std::atoi(argv[i + 2]))) : 512;
+			int ticks = i + 3 < argc ? std::max(1, std::atoi(argv[i + 3])) : 500;
+			runArenaBenchmark(snakes, size, ticks);
+			return 0;
+		}
+		else if (std::strcmp(argv[i], "--render-bench") == 0) {
+			return runRenderBenchmark(i + 1 < argc ? std::max(1, std::atoi(argv[i + 1])) : 600);
+		}
+		else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+			config.recordPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+			return runReplayFile(argv[i + 1], i + 2 < argc ? std::max(1, std::atoi(argv[i + 2])) : 1);
+		}
+		else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+			config.tracePath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--profile") == 0) {
+			config.showProfiler = true;
+		}
+		else if (std::strcmp(argv[i], "--fps-cap") == 0 && i + 1 < argc) {
+			config.pacing = FramePacing::Capped;
+			config.fpsCap = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--on-demand") == 0) {
+			config.pacing = FramePacing::OnDemand;
+		}
+		else if (std::strcmp(argv[i], "--board-texture") == 0) {
+			config.boardTexture = true;
+		}
+		else if (std::strcmp(argv[i], "--autopilot") == 0) {
+			config.autopilot = true;
+		}
+		else if (std::strcmp(argv[i], "--grid") == 0 && i + 2 < argc) {
+			config.gridWidth = std::min(maxGridSize, std::max(2, std::atoi(argv[++i])));
+			config.gridHeight = std::min(maxGridSize, std::max(2, std::atoi(argv[++i])));
+		}
+		else if (std::strcmp(argv[i], "--view") == 0 && i + 1 < argc) {
+			config.viewCells = std::max(1, std::atoi(argv[++i]));
+		}
+	}
+
+	Game game(1280, 720, "Snake Game", config);
 	game.run();
 	return 0;
 }
\ No newline at end of file